@@ -1,9 +1,12 @@
 #pragma once
 
 
+#include <felspar/coro/coroutine.hpp>
 #include <felspar/memory/sizes.hpp>
 
+#include <memory_resource>
 #include <new>
+#include <type_traits>
 #include <utility>
 
 
@@ -15,6 +18,111 @@ namespace felspar::coro {
     struct promise_allocator_impl;
 
 
+    /// ## Stateless allocators
+    /**
+     * Allocators that have no state, like the
+     * [`frame_pool`](./frame_pool.hpp), are used for every frame without
+     * needing to be passed to the coroutine.
+     */
+    template<typename Allocator>
+    concept stateless_allocator = std::is_empty_v<Allocator>
+            and std::is_default_constructible_v<Allocator>;
+
+
+    /**
+     * Nothing needs to be stored alongside the frame as the allocator can
+     * always be default constructed and the sized `operator delete` is given
+     * the frame size, so exactly the frame size is requested. An allocator
+     * passed to the coroutine is ignored.
+     */
+    template<stateless_allocator Allocator>
+    struct promise_allocator_impl<Allocator> {
+        void *operator new(std::size_t const psize) {
+            return Allocator{}.allocate(psize);
+        }
+        template<typename... Args>
+        void *operator new(std::size_t const psize, Allocator &, Args &...) {
+            return Allocator{}.allocate(psize);
+        }
+        template<typename This, typename... Args>
+        void *operator new(
+                std::size_t const psize, This &&, Allocator &, Args &...) {
+            return Allocator{}.allocate(psize);
+        }
+
+        void operator delete(void *const ptr, std::size_t const psize) {
+            Allocator{}.deallocate(ptr, psize);
+        }
+    };
+
+
+    /// ## Allocator resumption hooks
+    /**
+     * An allocator implementation may have `resumed` and `suspended` members.
+     * If it does then the promise types call `resumed` each time the
+     * coroutine starts running or carries on after a `co_yield`, and
+     * `suspended` just before it suspends or completes. The `task` and
+     * `stream` promises inherit the implementation publicly, so it can also
+     * provide an `await_transform` that uses `on_await` to have the hooks
+     * called around every `co_await`. See the
+     * [ambient allocator](./ambient.hpp) for an example.
+     */
+    template<typename Impl>
+    concept resumption_aware = requires(Impl &i) {
+        i.resumed();
+        i.suspended();
+    };
+
+    template<typename Impl, typename Awaiter>
+    struct resuming_awaiter {
+        Impl &impl;
+        Awaiter awaiter;
+        bool suspending = false;
+
+        bool await_ready() { return awaiter.await_ready(); }
+        template<typename H>
+        decltype(auto) await_suspend(H h) {
+            /// Must be done before the awaiter can hand the coroutine on to
+            /// be resumed elsewhere
+            suspending = true;
+            impl.suspended();
+            return awaiter.await_suspend(h);
+        }
+        decltype(auto) await_resume() {
+            if (suspending) { impl.resumed(); }
+            return awaiter.await_resume();
+        }
+    };
+
+    /// ### Hook an awaiter the promise creates
+    template<typename Impl, typename Awaiter>
+    inline auto on_resume(Impl &impl, Awaiter a) {
+        if constexpr (resumption_aware<Impl>) {
+            return resuming_awaiter<Impl, Awaiter>{impl, std::move(a)};
+        } else {
+            return a;
+        }
+    }
+    /// ### Hook an awaitable from `await_transform`
+    template<resumption_aware Impl, typename A>
+    inline auto on_await(Impl &impl, A &&a) {
+        if constexpr (requires {
+                                 std::forward<A>(a).operator co_await();
+                             }) {
+            return resuming_awaiter<
+                    Impl, decltype(std::forward<A>(a).operator co_await())>{
+                    impl, std::forward<A>(a).operator co_await()};
+        } else {
+            return resuming_awaiter<Impl, A &&>{impl, std::forward<A>(a)};
+        }
+    }
+    /// ### Hook the completion of the coroutine
+    template<typename Impl>
+    inline void on_final(Impl &impl) {
+        if constexpr (resumption_aware<Impl>) { impl.suspended(); }
+    }
+
+
     template<>
     struct promise_allocator_impl<void> {
         void *operator new(std::size_t sz) { return ::operator new(sz); }
@@ -83,4 +191,101 @@ namespace felspar::coro {
     };
 
 
+
+    /// ## Polymorphic memory resources
+    /**
+     * For `std::pmr::polymorphic_allocator` the memory resource is chosen at
+     * run time from the coroutine's arguments, following the standard
+     * library's conventions. Any of these are used, in order of preference:
+     *
+     * 1. `std::allocator_arg` followed by the allocator as the first two
+     *    arguments, or the two after the object for a member coroutine.
+     * 2. The allocator (or a `std::pmr::memory_resource *`) as the first
+     *    argument, as for other allocator types.
+     * 3. The allocator (or resource) as the last argument.
+     *
+     * Otherwise `std::pmr::get_default_resource()` is used. The resource is
+     * stored in front of the frame so that it can be released there.
+     */
+    template<typename T>
+    struct promise_allocator_impl<std::pmr::polymorphic_allocator<T>> {
+        struct allocation {
+            std::pmr::memory_resource *resource;
+        };
+        static constexpr std::size_t allocator_block_size =
+                felspar::memory::block_size(
+                        sizeof(allocation), alignof(std::max_align_t));
+
+        template<typename A>
+        static constexpr bool is_pmr_allocator = std::is_convertible_v<
+                A const &,
+                std::pmr::polymorphic_allocator<T>>;
+
+        template<typename... Args>
+        static std::pmr::memory_resource *find_resource(Args const &...args) {
+            std::pmr::memory_resource *resource = nullptr;
+            auto const from = [&resource]<typename A>(A const &a) {
+                resource = std::pmr::polymorphic_allocator<T>{a}.resource();
+            };
+            auto const tagged = [&]<typename Tag, typename A, typename... Rest>(
+                                        Tag const &, A const &a,
+                                        Rest const &...) {
+                if constexpr (
+                        std::is_same_v<Tag, std::allocator_arg_t>
+                        and is_pmr_allocator<A>) {
+                    from(a);
+                }
+            };
+            if constexpr (sizeof...(Args) >= 2) { tagged(args...); }
+            if constexpr (sizeof...(Args) >= 3) {
+                if (not resource) {
+                    [&]<typename This, typename... Rest>(
+                            This const &, Rest const &...rest) {
+                        tagged(rest...);
+                    }(args...);
+                }
+            }
+            if constexpr (sizeof...(Args) >= 1) {
+                if (not resource) {
+                    [&]<typename A, typename... Rest>(
+                            A const &a, Rest const &...) {
+                        if constexpr (is_pmr_allocator<A>) { from(a); }
+                    }(args...);
+                }
+                if (not resource) {
+                    /// Each argument overwrites the one before, so this ends
+                    /// up looking at the last one
+                    auto const check_last = [&]<typename A>(A const &a) {
+                        if constexpr (is_pmr_allocator<A>) {
+                            from(a);
+                        } else {
+                            resource = nullptr;
+                        }
+                    };
+                    (check_last(args), ...);
+                }
+            }
+            return resource ? resource : std::pmr::get_default_resource();
+        }
+
+        template<typename... Args>
+        void *operator new(std::size_t const psize, Args const &...args) {
+            auto const resource = find_resource(args...);
+            auto const base = static_cast<std::byte *>(resource->allocate(
+                    allocator_block_size + psize, alignof(std::max_align_t)));
+            new (base) allocation{resource};
+            return base + allocator_block_size;
+        }
+        void operator delete(void *const ptr, std::size_t const psize) {
+            auto const base =
+                    static_cast<std::byte *>(ptr) - allocator_block_size;
+            auto const resource =
+                    reinterpret_cast<allocation *>(base)->resource;
+            resource->deallocate(
+                    base, allocator_block_size + psize,
+                    alignof(std::max_align_t));
+        }
+    };
+
+
 }
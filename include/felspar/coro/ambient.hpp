@@ -0,0 +1,108 @@
+#pragma once
+
+
+#include <felspar/coro/allocator.hpp>
+
+#include <memory_resource>
+
+
+namespace felspar::coro {
+
+
+    /// ## The ambient memory resource
+    /**
+     * Coroutines whose allocator type is `ambient_allocator` allocate their
+     * frames from the current thread's ambient memory resource, which is
+     * `std::pmr::get_default_resource()` unless something has set another.
+     *
+     * Whilst such a coroutine is running it makes the resource its frame was
+     * allocated from the ambient one, putting back whatever was there before
+     * each time it suspends. So every coroutine created inside a coroutine
+     * tree is allocated from the same resource as the root of the tree,
+     * wherever and whenever the tree is resumed, without the resource having
+     * to be passed to each of them.
+     *
+     * An `ambient_scope` sets the ambient resource explicitly, for example to
+     * start a tree from a per-request arena, or to have part of a tree
+     * allocate from somewhere else. Coroutines that are created within the
+     * scope use it. The scope should not span a `co_await` or `co_yield`.
+     */
+    struct ambient_allocator {};
+
+
+    namespace detail {
+        inline std::pmr::memory_resource *&ambient_slot() noexcept {
+            thread_local std::pmr::memory_resource *resource = nullptr;
+            return resource;
+        }
+    }
+
+
+    /// ### The current ambient resource
+    inline std::pmr::memory_resource *ambient_resource() noexcept {
+        auto const resource = detail::ambient_slot();
+        return resource ? resource : std::pmr::get_default_resource();
+    }
+
+
+    /// ### Set the ambient resource for a scope
+    class ambient_scope final {
+        std::pmr::memory_resource *previous;
+
+      public:
+        explicit ambient_scope(std::pmr::memory_resource &resource) noexcept
+        : previous{std::exchange(detail::ambient_slot(), &resource)} {}
+        ambient_scope(ambient_scope const &) = delete;
+        ambient_scope &operator=(ambient_scope const &) = delete;
+        ~ambient_scope() { detail::ambient_slot() = previous; }
+    };
+
+
+    /// ### Promise allocation
+    /**
+     * The resource is stored in front of the frame so that it can be
+     * released to the right place. The promise makes it the ambient one
+     * whenever it is resumed.
+     */
+    template<>
+    struct promise_allocator_impl<ambient_allocator> {
+        struct allocation {
+            std::pmr::memory_resource *resource;
+        };
+        static constexpr std::size_t allocator_block_size =
+                felspar::memory::block_size(
+                        sizeof(allocation), alignof(std::max_align_t));
+
+        std::pmr::memory_resource *const resource = ambient_resource();
+        /// What to restore on suspension, which for the initial suspension
+        /// is whatever was there when the coroutine was created
+        std::pmr::memory_resource *previous = detail::ambient_slot();
+
+        void resumed() noexcept {
+            previous = std::exchange(detail::ambient_slot(), resource);
+        }
+        void suspended() noexcept { detail::ambient_slot() = previous; }
+        template<typename A>
+        auto await_transform(A &&a) {
+            return on_await(*this, std::forward<A>(a));
+        }
+
+        void *operator new(std::size_t const psize) {
+            auto const r = ambient_resource();
+            auto const base = static_cast<std::byte *>(r->allocate(
+                    allocator_block_size + psize, alignof(std::max_align_t)));
+            new (base) allocation{r};
+            return base + allocator_block_size;
+        }
+        void operator delete(void *const ptr, std::size_t const psize) {
+            auto const base =
+                    static_cast<std::byte *>(ptr) - allocator_block_size;
+            auto const r = reinterpret_cast<allocation *>(base)->resource;
+            r->deallocate(
+                    base, allocator_block_size + psize,
+                    alignof(std::max_align_t));
+        }
+    };
+
+
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+
+#include <felspar/coro/executor.hpp>
+#include <felspar/coro/stream.hpp>
+
+#include <atomic>
+#include <memory>
+
+
+namespace felspar::coro {
+
+
+    /// ## A thread safe data distribution bus
+    /**
+     * Like the [bus](./bus.hpp), values are delivered to the coroutines that
+     * are waiting at the time they are pushed, but the value may be pushed
+     * from any thread, and each waiter is continued on the
+     * [executor](./executor.hpp) that was current when it started to wait (or
+     * on the pushing thread if there wasn't one).
+     *
+     * Each value is allocated once and shared, immutably, by all of the
+     * subscribers that receive it. Waiting coroutines are kept in a lock free
+     * intrusive stack whose nodes are the awaitables themselves, so that
+     * neither waiting nor pushing takes a lock (apart from any taken by the
+     * executors the waiters are posted to).
+     *
+     * A coroutine that is suspended waiting on the bus must not be destroyed
+     * before it has been continued.
+     */
+    template<typename T>
+    class atomic_bus final {
+      public:
+        using value_type = T;
+        using message_type = std::shared_ptr<value_type const>;
+
+
+      private:
+        struct waiter {
+            std::coroutine_handle<> handle = {};
+            executor *exec = nullptr;
+            waiter *next = nullptr;
+            message_type message = {};
+        };
+        std::atomic<waiter *> head{nullptr};
+
+
+      public:
+        atomic_bus() = default;
+        atomic_bus(atomic_bus const &) = delete;
+        atomic_bus(atomic_bus &&) = delete;
+
+        atomic_bus &operator=(atomic_bus const &) = delete;
+        atomic_bus &operator=(atomic_bus &&) = delete;
+
+
+        /// ### Query the bus
+
+        /// #### Clients
+        /// Returns true if there is anything currently waiting on a bus value.
+        /// Other threads may change this at any time.
+        bool has_clients() const noexcept {
+            return head.load(std::memory_order_relaxed) != nullptr;
+        }
+
+
+        /// ### Return an awaitable for the next value
+        FELSPAR_CORO_WRAPPER auto next() {
+            struct FELSPAR_CORO_CRT awaitable {
+                explicit awaitable(atomic_bus &bb) : b{bb} {}
+                awaitable(awaitable const &) = delete;
+                awaitable(awaitable &&) = delete;
+                awaitable &operator=(awaitable const &) = delete;
+                awaitable &operator=(awaitable &&) = delete;
+
+
+                atomic_bus &b;
+                waiter node = {};
+
+
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<> h) noexcept {
+                    node.handle = h;
+                    node.exec = executor::current();
+                    node.next = b.head.load(std::memory_order_relaxed);
+                    while (not b.head.compare_exchange_weak(
+                            node.next, &node, std::memory_order_release,
+                            std::memory_order_relaxed)) {}
+                }
+                message_type await_resume() noexcept {
+                    return std::move(node.message);
+                }
+            };
+            return awaitable{*this};
+        }
+
+
+        /// ### Return a stream of values coming from the bus
+        /**
+         * The stream will never terminate. It must not be destroyed whilst it
+         * is waiting for a value.
+         */
+        coro::stream<message_type> stream() {
+            while (true) { co_yield (co_await next()); }
+        }
+
+
+        /// ### Publish a value to all waiting coroutines
+        /**
+         * Returns the number of coroutines that were given the value. Waiters
+         * are continued in the order in which they started to wait.
+         */
+        std::size_t push(T t) {
+            return push(std::make_shared<value_type const>(std::move(t)));
+        }
+        std::size_t push(message_type message) {
+            auto *w = head.exchange(nullptr, std::memory_order_acq_rel);
+            waiter *fifo = nullptr;
+            while (w) {
+                auto const next = std::exchange(w->next, fifo);
+                fifo = std::exchange(w, next);
+            }
+            std::size_t deliveries{};
+            while (fifo) {
+                /// The node lives in the waiting coroutine's frame, so it
+                /// must not be touched once that coroutine is continued
+                auto const next = fifo->next;
+                fifo->message = message;
+                resume_on(fifo->exec, fifo->handle);
+                fifo = next;
+                ++deliveries;
+            }
+            return deliveries;
+        }
+    };
+
+
+}
@@ -0,0 +1,380 @@
+#pragma once
+
+
+#include <felspar/coro/executor.hpp>
+#include <felspar/coro/stream.hpp>
+#include <felspar/coro/waiter_list.hpp>
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+
+namespace felspar::coro {
+
+
+    /// ## Bounded lock free MPMC ring buffer
+    /**
+     * Dmitry Vyukov's bounded multi-producer multi-consumer queue. Each cell
+     * carries a sequence number that tells producers and consumers whether it
+     * is ready for them, so the only contention is on the two position
+     * counters. The capacity is rounded up to a power of two.
+     */
+    template<typename T>
+    class mpmc_ring final {
+        struct cell {
+            std::atomic<std::size_t> sequence;
+            alignas(T) std::byte storage[sizeof(T)];
+
+            T *value() noexcept {
+                return std::launder(reinterpret_cast<T *>(storage));
+            }
+        };
+
+        std::size_t const mask;
+        std::unique_ptr<cell[]> cells;
+        alignas(64) std::atomic<std::size_t> enqueue_at{};
+        alignas(64) std::atomic<std::size_t> dequeue_at{};
+
+      public:
+        explicit mpmc_ring(std::size_t const capacity)
+        : mask{std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity) - 1},
+          cells{std::make_unique<cell[]>(mask + 1)} {
+            for (std::size_t i{}; i <= mask; ++i) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+        mpmc_ring(mpmc_ring const &) = delete;
+        mpmc_ring &operator=(mpmc_ring const &) = delete;
+        ~mpmc_ring() {
+            std::optional<T> discard;
+            while (try_pop(discard)) {}
+        }
+
+
+        [[nodiscard]] std::size_t capacity() const noexcept { return mask + 1; }
+
+
+        /// ### Push a value
+        /// The value is only moved from if there was space for it
+        bool try_push(T &value) {
+            auto pos = enqueue_at.load(std::memory_order_relaxed);
+            while (true) {
+                auto &c = cells[pos & mask];
+                auto const seq = c.sequence.load(std::memory_order_acquire);
+                auto const diff = static_cast<std::intptr_t>(seq)
+                        - static_cast<std::intptr_t>(pos);
+                if (diff == 0) {
+                    if (enqueue_at.compare_exchange_weak(
+                                pos, pos + 1, std::memory_order_relaxed)) {
+                        new (c.storage) T{std::move(value)};
+                        c.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = enqueue_at.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+
+        /// ### Pop a value
+        bool try_pop(std::optional<T> &into) {
+            auto pos = dequeue_at.load(std::memory_order_relaxed);
+            while (true) {
+                auto &c = cells[pos & mask];
+                auto const seq = c.sequence.load(std::memory_order_acquire);
+                auto const diff = static_cast<std::intptr_t>(seq)
+                        - static_cast<std::intptr_t>(pos + 1);
+                if (diff == 0) {
+                    if (dequeue_at.compare_exchange_weak(
+                                pos, pos + 1, std::memory_order_relaxed)) {
+                        into.emplace(std::move(*c.value()));
+                        c.value()->~T();
+                        c.sequence.store(
+                                pos + mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = dequeue_at.load(std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+
+
+    /// ## A thread safe bounded channel
+    /**
+     * The same interface as the [channel](./channel.hpp), but it may be sent
+     * to and received from on any thread. When neither side needs to wait the
+     * values pass through a lock free [ring buffer](#bounded-lock-free-mpmc-ring-buffer).
+     * Only coroutines that need to wait take a mutex to park themselves, and
+     * the other side only takes it if it sees that somebody is waiting.
+     *
+     * Woken coroutines are continued on the executor that was current when
+     * they started to wait, or directly on the waking thread if there was none.
+     *
+     * The capacity is rounded up to a power of two (with a minimum of two).
+     */
+    template<typename T>
+    class atomic_channel final {
+        struct waiting : public waiter_node {
+            executor *exec = nullptr;
+        };
+        struct sender : public waiting {
+            T *value = nullptr;
+            bool delivered = false;
+        };
+        struct receiver : public waiting {
+            std::optional<T> value = {};
+        };
+
+        mpmc_ring<T> ring;
+        std::atomic<bool> is_closed{false};
+        std::atomic<std::size_t> senders_waiting{}, receivers_waiting{};
+        std::mutex mtx;
+        waiter_list senders, receivers;
+
+
+        static void wake_all(waiter_list woken) {
+            while (auto *n = static_cast<waiting *>(woken.pop_front())) {
+                resume_on(n->exec, n->handle);
+            }
+        }
+
+        /// A value has been pushed, so hand values to waiting receivers
+        void pushed() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (receivers_waiting.load(std::memory_order_relaxed)) {
+                waiter_list woken;
+                {
+                    std::scoped_lock lock{mtx};
+                    while (auto *r = static_cast<receiver *>(receivers.front())) {
+                        if (not ring.try_pop(r->value)) { break; }
+                        receivers.remove(*r);
+                        receivers_waiting.fetch_sub(1, std::memory_order_relaxed);
+                        woken.push_back(*r);
+                    }
+                }
+                if (not woken.empty()) { popped(); }
+                wake_all(std::move(woken));
+            }
+        }
+        /// A value has been popped, so move waiting senders' values into the
+        /// ring
+        void popped() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (senders_waiting.load(std::memory_order_relaxed)) {
+                waiter_list woken;
+                {
+                    std::scoped_lock lock{mtx};
+                    while (auto *s = static_cast<sender *>(senders.front())) {
+                        if (not ring.try_push(*s->value)) { break; }
+                        s->delivered = true;
+                        senders.remove(*s);
+                        senders_waiting.fetch_sub(1, std::memory_order_relaxed);
+                        woken.push_back(*s);
+                    }
+                }
+                if (not woken.empty()) { pushed(); }
+                wake_all(std::move(woken));
+            }
+        }
+
+
+      public:
+        using value_type = T;
+
+        explicit atomic_channel(std::size_t const capacity) : ring{capacity} {}
+        atomic_channel(atomic_channel const &) = delete;
+        atomic_channel(atomic_channel &&) = delete;
+        atomic_channel &operator=(atomic_channel const &) = delete;
+        atomic_channel &operator=(atomic_channel &&) = delete;
+
+
+        /// ### Query the channel
+        [[nodiscard]] std::size_t capacity() const noexcept {
+            return ring.capacity();
+        }
+        [[nodiscard]] bool closed() const noexcept {
+            return is_closed.load(std::memory_order_acquire);
+        }
+
+
+        /// ### Send a value
+        /**
+         * The awaitable returns true if the value was accepted by the channel
+         * and false if the channel was closed before it could be.
+         */
+        auto send(T t) {
+            struct awaitable {
+                awaitable(atomic_channel &c, T t)
+                : ch{c}, value{std::move(t)} {}
+                awaitable(awaitable const &) = delete;
+                awaitable(awaitable &&) = delete;
+                ~awaitable() {
+                    if (node.handle) {
+                        std::scoped_lock lock{ch.mtx};
+                        if (ch.senders.remove(node)) {
+                            ch.senders_waiting.fetch_sub(
+                                    1, std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+                awaitable &operator=(awaitable const &) = delete;
+                awaitable &operator=(awaitable &&) = delete;
+
+
+                atomic_channel &ch;
+                T value;
+                sender node = {};
+                bool sent = false;
+
+
+                bool await_ready() {
+                    if (ch.closed()) {
+                        return true;
+                    } else if (ch.ring.try_push(value)) {
+                        sent = true;
+                        ch.pushed();
+                        return true;
+                    } else {
+                        return false;
+                    }
+                }
+                bool await_suspend(std::coroutine_handle<> h) {
+                    {
+                        std::scoped_lock lock{ch.mtx};
+                        ch.senders_waiting.fetch_add(
+                                1, std::memory_order_relaxed);
+                        std::atomic_thread_fence(std::memory_order_seq_cst);
+                        if (ch.closed()) {
+                            ch.senders_waiting.fetch_sub(
+                                    1, std::memory_order_relaxed);
+                            return false;
+                        } else if (not ch.ring.try_push(value)) {
+                            node.handle = h;
+                            node.exec = executor::current();
+                            node.value = &value;
+                            ch.senders.push_back(node);
+                            return true;
+                        }
+                        ch.senders_waiting.fetch_sub(
+                                1, std::memory_order_relaxed);
+                    }
+                    sent = true;
+                    ch.pushed();
+                    return false;
+                }
+                bool await_resume() noexcept {
+                    node.handle = {};
+                    return sent or node.delivered;
+                }
+            };
+            return awaitable{*this, std::move(t)};
+        }
+
+
+        /// ### Receive a value
+        /// The awaitable returns an empty value once the channel is closed
+        /// and drained
+        auto receive() {
+            struct awaitable {
+                explicit awaitable(atomic_channel &c) : ch{c} {}
+                awaitable(awaitable const &) = delete;
+                awaitable(awaitable &&) = delete;
+                ~awaitable() {
+                    if (node.handle) {
+                        std::scoped_lock lock{ch.mtx};
+                        if (ch.receivers.remove(node)) {
+                            ch.receivers_waiting.fetch_sub(
+                                    1, std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+                awaitable &operator=(awaitable const &) = delete;
+                awaitable &operator=(awaitable &&) = delete;
+
+
+                atomic_channel &ch;
+                receiver node = {};
+
+
+                bool await_ready() {
+                    if (ch.ring.try_pop(node.value)) {
+                        ch.popped();
+                        return true;
+                    } else {
+                        return ch.closed();
+                    }
+                }
+                bool await_suspend(std::coroutine_handle<> h) {
+                    {
+                        std::scoped_lock lock{ch.mtx};
+                        ch.receivers_waiting.fetch_add(
+                                1, std::memory_order_relaxed);
+                        std::atomic_thread_fence(std::memory_order_seq_cst);
+                        bool const got = ch.ring.try_pop(node.value);
+                        if (not got and not ch.closed()) {
+                            node.handle = h;
+                            node.exec = executor::current();
+                            ch.receivers.push_back(node);
+                            return true;
+                        }
+                        ch.receivers_waiting.fetch_sub(
+                                1, std::memory_order_relaxed);
+                        if (not got) { return false; }
+                    }
+                    ch.popped();
+                    return false;
+                }
+                std::optional<T> await_resume() {
+                    node.handle = {};
+                    return std::move(node.value);
+                }
+            };
+            return awaitable{*this};
+        }
+
+
+        /// ### Close the channel
+        /**
+         * Waiting senders are woken and their values are not sent. Waiting
+         * receivers are woken and will get any values that are still left in
+         * the buffer, or an empty value if there are none.
+         */
+        void close() {
+            is_closed.store(true, std::memory_order_release);
+            waiter_list woken;
+            {
+                std::scoped_lock lock{mtx};
+                while (auto *r = static_cast<receiver *>(receivers.pop_front())) {
+                    ring.try_pop(r->value);
+                    woken.push_back(*r);
+                }
+                receivers_waiting.store(0, std::memory_order_relaxed);
+                while (auto *s = senders.pop_front()) { woken.push_back(*s); }
+                senders_waiting.store(0, std::memory_order_relaxed);
+            }
+            wake_all(std::move(woken));
+        }
+
+
+        /// ### Return a stream of the values received from the channel
+        /// The stream ends when the channel is closed and drained
+        coro::stream<T> stream() {
+            while (auto v = co_await receive()) { co_yield std::move(*v); }
+        }
+    };
+
+
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+
+#include <felspar/coro/executor.hpp>
+#include <felspar/exceptions.hpp>
+
+#include <atomic>
+#include <optional>
+
+
+namespace felspar::coro {
+
+
+    /// ## Thread safe waiting for an `atomic_future`
+    /**
+     * Waiting coroutines are kept in a lock free intrusive stack whose nodes
+     * are the awaitables themselves, so waiting never allocates. Once the value
+     * is set the stack head is replaced with a marker (the address of the
+     * future) so that late arrivals don't suspend.
+     *
+     * Each waiter remembers the [executor](./executor.hpp) that was current
+     * when it suspended and is posted back to it. Waiters with no executor
+     * are resumed directly on the thread that sets the value.
+     *
+     * A coroutine that is suspended waiting on the future must not be
+     * destroyed before the value is set.
+     */
+    class atomic_future_waiters {
+      protected:
+        struct waiter {
+            std::coroutine_handle<> handle = {};
+            executor *exec = nullptr;
+            waiter *next = nullptr;
+        };
+
+        atomic_future_waiters() = default;
+        atomic_future_waiters(atomic_future_waiters const &) = delete;
+        atomic_future_waiters &operator=(atomic_future_waiters const &) = delete;
+
+        bool is_set() const noexcept {
+            return head.load(std::memory_order_acquire) == set_marker();
+        }
+        void claim(std::source_location const &loc) {
+            if (setting.exchange(true, std::memory_order_relaxed)) {
+                throw stdexcept::logic_error{
+                        "The future already has a value set", loc};
+            }
+        }
+
+        /// Returns false if the value has already been set
+        bool add(waiter &w, std::coroutine_handle<> h) noexcept {
+            w.handle = h;
+            w.exec = executor::current();
+            void *old = head.load(std::memory_order_acquire);
+            do {
+                if (old == set_marker()) { return false; }
+                w.next = static_cast<waiter *>(old);
+            } while (not head.compare_exchange_weak(
+                    old, &w, std::memory_order_release,
+                    std::memory_order_acquire));
+            return true;
+        }
+
+        /// Publishes the value and continues all of the waiters, in the
+        /// order in which they arrived
+        void release() {
+            auto *w = static_cast<waiter *>(
+                    head.exchange(set_marker(), std::memory_order_acq_rel));
+            waiter *fifo = nullptr;
+            while (w) {
+                auto const next = std::exchange(w->next, fifo);
+                fifo = std::exchange(w, next);
+            }
+            while (fifo) {
+                /// The node lives in the waiting coroutine's frame, so it
+                /// must not be touched once that coroutine is continued
+                auto const next = fifo->next;
+                resume_on(fifo->exec, fifo->handle);
+                fifo = next;
+            }
+        }
+
+      private:
+        std::atomic<void *> head{nullptr};
+        std::atomic<bool> setting{false};
+
+        void *set_marker() const noexcept {
+            return const_cast<atomic_future_waiters *>(this);
+        }
+    };
+
+
+    /// ## Thread safe asynchronous future
+    /**
+     * Like the [future](./future.hpp), but the value may be set from any
+     * thread. Waiting coroutines are continued on the executor they were
+     * running on when they started to wait.
+     */
+    template<typename T>
+    class atomic_future final : private atomic_future_waiters {
+        std::optional<T> m_value;
+
+      public:
+        using value_type = T;
+
+        atomic_future() = default;
+
+
+        /// ### Query the future
+        bool has_value() const noexcept { return is_set(); }
+        explicit operator bool() const noexcept { return has_value(); }
+
+        value_type &
+                value(std::source_location const &loc =
+                              std::source_location::current()) {
+            if (not has_value()) {
+                throw felspar::stdexcept::logic_error{
+                        "Future does not contain a value", loc};
+            } else {
+                return *m_value;
+            }
+        }
+        value_type const &
+                value(std::source_location const &loc =
+                              std::source_location::current()) const {
+            if (not has_value()) {
+                throw felspar::stdexcept::logic_error{
+                        "Future does not contain a value", loc};
+            } else {
+                return *m_value;
+            }
+        }
+
+
+        /// ### Coroutine interface
+        FELSPAR_CORO_WRAPPER auto operator co_await() {
+            struct FELSPAR_CORO_CRT awaitable {
+                explicit awaitable(atomic_future &f) : fut{f} {}
+                awaitable(awaitable const &) = delete;
+                awaitable(awaitable &&) = delete;
+                awaitable &operator=(awaitable const &) = delete;
+                awaitable &operator=(awaitable &&) = delete;
+
+
+                atomic_future &fut;
+                waiter node = {};
+
+
+                bool await_ready() const noexcept { return fut.has_value(); }
+                bool await_suspend(std::coroutine_handle<> h) noexcept {
+                    return fut.add(node, h);
+                }
+                value_type &await_resume() noexcept { return *fut.m_value; }
+            };
+            return awaitable{*this};
+        }
+
+
+        /// ### Set the future's value
+        void set_value(
+                value_type t,
+                std::source_location const &loc =
+                        std::source_location::current()) {
+            claim(loc);
+            m_value = std::move(t);
+            release();
+        }
+    };
+
+    template<>
+    class atomic_future<void> final : private atomic_future_waiters {
+      public:
+        using value_type = void;
+
+        atomic_future() = default;
+
+
+        /// ### Query the future
+        bool has_value() const noexcept { return is_set(); }
+        explicit operator bool() const noexcept { return has_value(); }
+
+        void
+                value(std::source_location const &loc =
+                              std::source_location::current()) const {
+            if (not has_value()) {
+                throw felspar::stdexcept::logic_error{
+                        "Future does not contain a value", loc};
+            }
+        }
+
+
+        /// ### Coroutine interface
+        FELSPAR_CORO_WRAPPER auto operator co_await() {
+            struct FELSPAR_CORO_CRT awaitable {
+                explicit awaitable(atomic_future &f) : fut{f} {}
+                awaitable(awaitable const &) = delete;
+                awaitable(awaitable &&) = delete;
+                awaitable &operator=(awaitable const &) = delete;
+                awaitable &operator=(awaitable &&) = delete;
+
+
+                atomic_future &fut;
+                waiter node = {};
+
+
+                bool await_ready() const noexcept { return fut.has_value(); }
+                bool await_suspend(std::coroutine_handle<> h) noexcept {
+                    return fut.add(node, h);
+                }
+                void await_resume() const noexcept {}
+            };
+            return awaitable{*this};
+        }
+
+
+        /// ### Set the future's value
+        void set_value(
+                std::source_location const &loc =
+                        std::source_location::current()) {
+            claim(loc);
+            release();
+        }
+    };
+
+
+}
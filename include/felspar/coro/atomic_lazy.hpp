@@ -0,0 +1,100 @@
+#pragma once
+
+
+#include <felspar/coro/allocator.hpp>
+#include <felspar/coro/coroutine.hpp>
+
+#include <atomic>
+#include <exception>
+#include <optional>
+
+
+namespace felspar::coro {
+
+
+    /// A thread safe [`lazy`](./lazy.hpp). The first thread to ask for the
+    /// value runs the coroutine, and any other thread that asks whilst it is
+    /// running blocks until it has finished. Once the value is available
+    /// reading it costs a single acquire load.
+    template<typename L, typename Allocator = void>
+    class atomic_lazy final {
+      public:
+        atomic_lazy(atomic_lazy const &) = delete;
+        atomic_lazy(atomic_lazy &&) = delete;
+        atomic_lazy &operator=(atomic_lazy const &) = delete;
+        atomic_lazy &operator=(atomic_lazy &&) = delete;
+        ~atomic_lazy() = default;
+
+        struct promise_type : private promise_allocator_impl<Allocator> {
+            using allocator_impl = promise_allocator_impl<Allocator>;
+            using allocator_impl::operator new;
+            using allocator_impl::operator delete;
+
+            std::exception_ptr eptr;
+            std::optional<L> value;
+            using handle_type = unique_handle<promise_type>;
+
+            atomic_lazy get_return_object() {
+                return {handle_type::from_promise(*this)};
+            }
+
+            template<typename A>
+            std::suspend_always await_transform(A &&) = delete;
+
+            void unhandled_exception() { eptr = std::current_exception(); }
+            void return_value(L v) { value = std::move(v); }
+
+            auto initial_suspend() noexcept {
+                return on_resume<allocator_impl>(*this, std::suspend_always{});
+            }
+            auto final_suspend() noexcept {
+                on_final<allocator_impl>(*this);
+                return std::suspend_always{};
+            }
+        };
+        friend promise_type;
+
+        /// Returns a copy of the value
+        L operator()() { return value(); }
+        /// Returns the value without copying it
+        L const &value() {
+            if (state.load(std::memory_order_acquire) == has_value) {
+                return *coro.promise().value;
+            } else {
+                return evaluate();
+            }
+        }
+
+      private:
+        using handle_type = typename promise_type::handle_type;
+        atomic_lazy(handle_type h) : coro{std::move(h)} {}
+        handle_type coro;
+
+        enum status : int { waiting, running, has_value, has_exception };
+        std::atomic<int> state = waiting;
+
+        L const &evaluate() {
+            int expected = waiting;
+            if (state.compare_exchange_strong(
+                        expected, running, std::memory_order_acquire)) {
+                coro.resume();
+                state.store(
+                        coro.promise().eptr ? has_exception : has_value,
+                        std::memory_order_release);
+                state.notify_all();
+            } else {
+                while (expected == running) {
+                    state.wait(running, std::memory_order_acquire);
+                    expected = state.load(std::memory_order_acquire);
+                }
+            }
+            if (coro.promise().eptr) {
+                std::rethrow_exception(coro.promise().eptr);
+            } else {
+                return *coro.promise().value;
+            }
+        }
+    };
+
+
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+
+#include <felspar/coro/atomic_future.hpp>
+#include <felspar/coro/shared_task.hpp>
+
+#include <atomic>
+
+
+namespace felspar::coro {
+
+
+    template<typename T, typename Allocator = void>
+    class atomic_shared_task;
+
+
+    template<typename T, typename Allocator>
+    struct atomic_shared_task_promise :
+    public promise_allocator_impl<Allocator>,
+            public shared_task_result<T>,
+            private atomic_future_waiters {
+        using allocator_impl = promise_allocator_impl<Allocator>;
+        using allocator_impl::operator new;
+        using allocator_impl::operator delete;
+        using waiter_type = waiter;
+
+        std::atomic<std::size_t> references = 1;
+        std::atomic<bool> started = false;
+
+        atomic_shared_task<T, Allocator> get_return_object();
+
+        bool completed() const noexcept { return is_set(); }
+        /// Returns false if the task has already completed
+        bool wait(waiter_type &w, std::coroutine_handle<> h) noexcept {
+            return add(w, h);
+        }
+        void reference() noexcept {
+            references.fetch_add(1, std::memory_order_relaxed);
+        }
+        /// Returns true if this was the last reference
+        bool unreference() noexcept {
+            return references.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+
+        auto initial_suspend() noexcept {
+            return on_resume<allocator_impl>(*this, std::suspend_always{});
+        }
+        auto final_suspend() noexcept {
+            on_final<allocator_impl>(*this);
+            struct awaitable {
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(
+                        std::coroutine_handle<atomic_shared_task_promise> h)
+                        const noexcept {
+                    auto &p = h.promise();
+                    p.reference();
+                    p.release();
+                    if (p.unreference()) { h.destroy(); }
+                }
+                void await_resume() const noexcept {}
+            };
+            return awaitable{};
+        }
+    };
+
+
+    /// ## Thread safe tasks that can be awaited many times
+    /**
+     * Like the [`shared_task`](./shared_task.hpp), but it may be awaited,
+     * copied and destroyed from any thread. Waiting coroutines are continued
+     * on the [executor](./executor.hpp) that was current when they started
+     * to wait, or on the thread that completes the task if there wasn't one.
+     *
+     * A coroutine that is suspended waiting on the task must not be
+     * destroyed before the task has completed.
+     */
+    template<typename T, typename Allocator>
+    class [[nodiscard]] FELSPAR_CORO_CRT atomic_shared_task final {
+        friend struct atomic_shared_task_promise<T, Allocator>;
+
+
+      public:
+        using value_type = T;
+        using allocator_type = Allocator;
+        using promise_type =
+                atomic_shared_task_promise<value_type, allocator_type>;
+        using handle_type = std::coroutine_handle<promise_type>;
+        using reference = typename shared_task_result<T>::reference;
+
+
+        /// ### Construction
+        atomic_shared_task(atomic_shared_task const &t) noexcept
+        : coro{t.coro} {
+            if (coro) { coro.promise().reference(); }
+        }
+        atomic_shared_task(atomic_shared_task &&t) noexcept
+        : coro{std::exchange(t.coro, {})} {}
+        ~atomic_shared_task() { drop(); }
+
+        atomic_shared_task &operator=(atomic_shared_task const &t) noexcept {
+            atomic_shared_task c{t};
+            std::swap(coro, c.coro);
+            return *this;
+        }
+        atomic_shared_task &operator=(atomic_shared_task &&t) noexcept {
+            drop();
+            coro = std::exchange(t.coro, {});
+            return *this;
+        }
+
+
+        /// ### Query the task
+        [[nodiscard]] bool done() const noexcept {
+            return coro.promise().completed();
+        }
+
+
+        /// ### Awaitable
+        FELSPAR_CORO_WRAPPER auto operator co_await() const {
+            struct FELSPAR_CORO_CRT awaitable {
+                atomic_shared_task t;
+                typename promise_type::waiter_type node = {};
+
+                awaitable(atomic_shared_task const &st) : t{st} {}
+                awaitable(awaitable const &) = delete;
+                awaitable(awaitable &&) = delete;
+                awaitable &operator=(awaitable const &) = delete;
+                awaitable &operator=(awaitable &&) = delete;
+
+                bool await_ready() const noexcept { return t.done(); }
+                std::coroutine_handle<>
+                        await_suspend(std::coroutine_handle<> h) noexcept {
+                    /// Once waiting, another thread may continue `h` and
+                    /// destroy this awaitable, so only locals are used after
+                    auto const coro = t.coro;
+                    bool const start = not coro.promise().started.exchange(
+                            true, std::memory_order_acq_rel);
+                    if (not coro.promise().wait(node, h)) {
+                        return h;
+                    } else if (start) {
+                        return coro;
+                    } else {
+                        return std::noop_coroutine();
+                    }
+                }
+                reference await_resume() const {
+                    return t.coro.promise().result();
+                }
+            };
+            return awaitable{*this};
+        }
+
+
+      private:
+        handle_type coro;
+
+        explicit atomic_shared_task(handle_type h) : coro{h} {}
+
+        void drop() noexcept {
+            if (coro and coro.promise().unreference()) { coro.destroy(); }
+            coro = {};
+        }
+    };
+
+
+    template<typename T, typename Allocator>
+    inline auto atomic_shared_task_promise<T, Allocator>::get_return_object()
+            -> atomic_shared_task<T, Allocator> {
+        return atomic_shared_task<T, Allocator>{
+                std::coroutine_handle<atomic_shared_task_promise>::from_promise(
+                        *this)};
+    }
+
+
+}
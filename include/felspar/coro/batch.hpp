@@ -0,0 +1,129 @@
+#pragma once
+
+
+#include <felspar/coro/coroutine.hpp>
+
+#include <span>
+#include <type_traits>
+
+
+namespace felspar::coro {
+
+
+    /// ## Intercepting yielded values
+    /**
+     * Whilst a sink is installed in a [stream](./stream.hpp) or
+     * [generator](./generator.hpp) promise each yielded value is pushed into
+     * it instead of being handed to the consumer. The sink's answer decides
+     * whether the producer suspends: it only does so once the sink has a value
+     * ready for the consumer or it doesn't want any more. This is how the
+     * [fused pipelines](./pipeline.hpp) run all of their stages inside the
+     * producer's `co_yield`.
+     */
+    struct sink_status {
+        /// A value is ready for the consumer
+        bool deliver = false;
+        /// The sink will not accept any more values
+        bool stop = false;
+
+        bool suspend() const noexcept { return deliver or stop; }
+    };
+    template<typename Y>
+    struct yield_sink {
+        virtual sink_status push(Y &&) = 0;
+
+      protected:
+        ~yield_sink() = default;
+    };
+
+
+    /// ## Batched delivery of yielded values
+    /**
+     * Used by the [stream](./stream.hpp) and [generator](./generator.hpp)
+     * promises so that a consumer can ask for many values per resumption.
+     * Whilst a consumer's buffer is installed each yielded value is moved
+     * straight into it, and the producer only suspends once it is full.
+     *
+     * A producer may also yield a `std::span<Y>`. Its elements are moved out
+     * either into the consumer's buffer or one at a time as single values,
+     * and the producer is only resumed once they have all been taken.
+     */
+    template<typename Y>
+    struct batch_buffer {
+        /// The consumer's buffer, empty when it isn't asking for a batch
+        std::span<Y> batch = {};
+        std::size_t batched = {};
+        /// The rest of a span that the producer has yielded
+        std::span<Y> pending = {};
+        /// Takes the yielded values when set
+        yield_sink<Y> *sink = nullptr;
+
+
+        /// Batches are delivered by assigning into the consumer's buffer
+        static constexpr bool batchable = std::is_move_assignable_v<Y>;
+
+        bool batching() const noexcept { return batchable and not batch.empty(); }
+        bool full() const noexcept { return batched == batch.size(); }
+
+        void start_batch(std::span<Y> const buffer) noexcept {
+            batch = buffer;
+            batched = {};
+            drain();
+        }
+        std::size_t end_batch() noexcept {
+            batch = {};
+            return std::exchange(batched, {});
+        }
+
+        void add(Y &&y) {
+            if constexpr (batchable) { batch[batched++] = std::move(y); }
+        }
+        void drain() {
+            if constexpr (batchable) {
+                auto const space = batch.size() - batched;
+                auto const count =
+                        pending.size() < space ? pending.size() : space;
+                for (std::size_t index{}; index < count; ++index) {
+                    batch[batched + index] = std::move(pending[index]);
+                }
+                batched += count;
+                pending = pending.subspan(count);
+            }
+        }
+
+        /// Push pending values into the sink until it wants the consumer
+        sink_status feed_pending() {
+            sink_status status;
+            while (not status.suspend() and not pending.empty()) {
+                status = sink->push(std::move(pending.front()));
+                pending = pending.subspan(1);
+            }
+            return status;
+        }
+    };
+
+
+    /// ## Yield awaitable that may not suspend
+    /**
+     * Only suspends if asked to, in which case it transfers to the
+     * continuation (or back to whatever resumed the coroutine if there is
+     * none).
+     */
+    struct conditional_continuation {
+        std::coroutine_handle<> continuation;
+        bool suspend;
+
+        bool await_ready() const noexcept { return not suspend; }
+        std::coroutine_handle<>
+                await_suspend(std::coroutine_handle<>) const noexcept {
+            if (continuation) {
+                return continuation;
+            } else {
+                return std::noop_coroutine();
+            }
+        }
+        void await_resume() const noexcept {}
+    };
+
+
+}
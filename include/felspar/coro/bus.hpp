@@ -2,11 +2,12 @@
 
 
 #include <felspar/coro/coroutine.hpp>
+#include <felspar/coro/executor.hpp>
 #include <felspar/coro/stream.hpp>
 #include <felspar/coro/task.hpp>
+#include <felspar/coro/waiter_list.hpp>
 
 #include <optional>
-#include <vector>
 
 
 namespace felspar::coro {
@@ -24,16 +25,22 @@ namespace felspar::coro {
      *
      * **NB** The bus is an inherently lossy mechanism. Only coroutines
      * currently waiting when a new value comes in will be notified.
+     *
+     * If the bus is given an [executor](./executor.hpp) then waiting
+     * coroutines are posted to it rather than being resumed by `push`. They
+     * will see whichever value is the latest at the time they are run.
      */
     template<typename T>
     class bus final {
         std::optional<T> current;
-        std::vector<std::coroutine_handle<>> waiting, processing;
+        waiter_list waiting;
+        executor *exec = nullptr;
 
       public:
         using value_type = T;
 
         bus() = default;
+        explicit bus(executor &e) : exec{&e} {}
         bus(bus &&) = default;
         bus(bus const &) = delete;
 
@@ -44,11 +51,10 @@ namespace felspar::coro {
         /// ### Query the bus
 
         /// #### Clients
-        /// Returns true if there is anything currently waiting on a bus value,
-        /// or if value processing is ongoing
-        bool has_clients() const noexcept {
-            return not waiting.empty() or not processing.empty();
-        }
+        /// Returns true if there is anything currently waiting for the next
+        /// bus value. Whilst `push` is delivering a value, the coroutines yet
+        /// to be given it are not counted
+        bool has_clients() const noexcept { return not waiting.empty(); }
 
         /// #### The latest value
         /// This will only be empty until the first value is pushed
@@ -60,32 +66,24 @@ namespace felspar::coro {
             struct awaitable {
                 awaitable(bus &bb) : b{bb} {}
                 awaitable(awaitable const &) = delete;
-                // TODO We could be movable
-                awaitable(awaitable &&) = delete;
-                ~awaitable() {
-                    if (waiting_handle) {
-                        std::erase(b.waiting, waiting_handle);
-                        std::erase(b.processing, waiting_handle);
-                    }
-                }
+                /// Only before it has been awaited
+                awaitable(awaitable &&o) noexcept : b{o.b} {}
+                ~awaitable() { b.waiting.remove(node); }
 
                 awaitable &operator=(awaitable const &) = delete;
                 awaitable &operator=(awaitable &&) = delete;
 
 
                 bus &b;
-                std::coroutine_handle<> waiting_handle = {};
+                waiter_node node = {};
 
 
                 bool await_ready() const noexcept { return false; }
-                void await_suspend(std::coroutine_handle<> h) {
-                    waiting_handle = h;
-                    b.waiting.push_back(h);
-                }
-                T &await_resume() {
-                    waiting_handle = {};
-                    return *b.current;
+                void await_suspend(std::coroutine_handle<> h) noexcept {
+                    node.handle = h;
+                    b.waiting.push_back(node);
                 }
+                T &await_resume() { return *b.current; }
             };
             return awaitable{*this};
         }
@@ -106,20 +104,17 @@ namespace felspar::coro {
         /**
          * Returns the number of coroutines that received a copy of the message.
          *
-         * Waiting coroutines are continued synchronously. This can lead to
-         * undefined behaviour if it is a coroutine that has pushed the value
-         * and the value causes the coroutine's stack frame to be destroyed.
+         * Without an executor waiting coroutines are continued synchronously.
+         * This can lead to undefined behaviour if it is a coroutine that has
+         * pushed the value and the value causes the coroutine's stack frame to
+         * be destroyed.
          */
         std::size_t push(T t) {
             current = std::move(t);
-            std::swap(processing, waiting);
-            std::size_t const deliveries{processing.size()};
-            while (not processing.empty()) {
-                auto handle = processing.back();
-                processing.pop_back();
-                handle.resume();
-            }
-            return deliveries;
+            /// Coroutines that wait again whilst the value is being delivered
+            /// wait for the next value
+            return waiting.drain(
+                    [this](waiter_node &n) { resume_on(exec, n.handle); });
         }
 
 
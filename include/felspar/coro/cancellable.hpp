@@ -2,8 +2,8 @@
 
 
 #include <felspar/coro/coroutine.hpp>
-
-#include <vector>
+#include <felspar/coro/executor.hpp>
+#include <felspar/coro/waiter_list.hpp>
 
 
 namespace felspar::coro {
@@ -11,13 +11,25 @@ namespace felspar::coro {
 
     /// ## Cancellable coroutines
     class cancellable {
-        std::vector<std::coroutine_handle<>> continuations = {};
+        /// A waiting coroutine, along with the continuation of the awaitable
+        /// it is waiting on if that was wrapped by `signal_or`
+        struct waiter : public waiter_node {
+            void (*disarm)(void *) = nullptr;
+            void *inner = nullptr;
+        };
+        waiter_list continuations = {};
         bool signalled = false;
+        executor *exec = nullptr;
 
-        void remove(std::coroutine_handle<> h) { std::erase(continuations, h); }
+        void remove(waiter_node &n) noexcept { continuations.remove(n); }
 
       public:
         cancellable() {}
+        /**
+         * When given an [executor](./executor.hpp) the continuations are
+         * posted to it by `cancel` rather than being resumed directly.
+         */
+        explicit cancellable(executor &e) : exec{&e} {}
         cancellable(cancellable const &) = delete;
         cancellable(cancellable &&) = delete;
         cancellable &operator=(cancellable const &) = delete;
@@ -28,40 +40,50 @@ namespace felspar::coro {
         /// Used externally to cancel the controlled coroutine
         void cancel() {
             signalled = true;
-            while (continuations.size()) {
-                auto h = continuations.back();
-                continuations.pop_back();
-                h.resume();
+            while (auto *n = static_cast<waiter *>(continuations.pop_front())) {
+                /// The wrapped awaitable is disarmed first so that it can't
+                /// also continue the coroutine if it completes before an
+                /// executor gets to run it
+                if (n->disarm) { n->disarm(n->inner); }
+                resume_on(exec, n->handle);
             }
         }
         bool cancelled() const noexcept { return signalled; }
 
 
         /// ### `signal_or`
-        /// Wrap an awaitable so that an early resumption can be signalled
+        /**
+         * Wrap an awaitable so that an early resumption can be signalled. The
+         * awaitable must have a `continuation` member, which is cleared if
+         * the coroutine is cancelled so that the awaitable won't also
+         * continue it.
+         */
         template<typename A>
         FELSPAR_CORO_WRAPPER auto signal_or(A coro_awaitable) {
             struct FELSPAR_CORO_CRT awaitable {
                 A a;
                 cancellable &b;
-                std::coroutine_handle<> continuation = {};
+                waiter node = {};
 
-                ~awaitable() { b.remove(continuation); }
+                ~awaitable() { b.remove(node); }
 
                 bool await_ready() const noexcept {
                     return b.signalled or a.await_ready();
                 }
                 auto await_suspend(std::coroutine_handle<> h) noexcept {
                     /// `h` is the coroutine making use of the `cancellable`
-                    continuation = h;
-                    b.continuations.push_back(h);
+                    node.handle = h;
+                    node.disarm = [](void *const inner) {
+                        static_cast<A *>(inner)->continuation = {};
+                    };
+                    node.inner = &a;
+                    b.continuations.push_back(node);
                     return a.await_suspend(h);
                 }
                 auto await_resume()
                         -> decltype(std::declval<A>().await_resume()) {
-                    b.remove(continuation);
+                    b.remove(node);
                     if (b.signalled) {
-                        a.continuation = {};
                         return {};
                     } else {
                         return a.await_resume();
@@ -76,16 +98,16 @@ namespace felspar::coro {
         FELSPAR_CORO_WRAPPER auto operator co_await() {
             struct FELSPAR_CORO_CRT awaitable {
                 cancellable &b;
-                std::coroutine_handle<> continuation = {};
+                waiter node = {};
 
-                ~awaitable() { b.remove(continuation); }
+                ~awaitable() { b.remove(node); }
 
                 bool await_ready() const noexcept { return b.signalled; }
                 void await_suspend(std::coroutine_handle<> h) noexcept {
-                    continuation = h;
-                    b.continuations.push_back(h);
+                    node.handle = h;
+                    b.continuations.push_back(node);
                 }
-                void await_resume() noexcept { b.remove(continuation); }
+                void await_resume() noexcept { b.remove(node); }
             };
             return awaitable{*this};
         }
@@ -0,0 +1,202 @@
+#pragma once
+
+
+#include <felspar/coro/executor.hpp>
+#include <felspar/coro/stream.hpp>
+#include <felspar/coro/waiter_list.hpp>
+
+#include <memory>
+#include <optional>
+
+
+namespace felspar::coro {
+
+
+    /// ## A bounded channel
+    /**
+     * Values sent into the channel are buffered in a fixed capacity ring
+     * buffer. Sending suspends the sender whilst the buffer is full, and
+     * receiving suspends the receiver whilst it is empty. A capacity of zero
+     * is allowed, in which case every value is handed directly from a sender
+     * to a receiver.
+     *
+     * There is no thread synchronisation, see the
+     * [atomic_channel](./atomic_channel.hpp) for that. Coroutines that are
+     * unblocked by a `send`, `receive` or `close` are resumed synchronously
+     * unless the channel has been given an [executor](./executor.hpp).
+     *
+     * Once closed, sends fail and receivers will get an empty value once the
+     * buffer has been drained.
+     */
+    template<typename T>
+    class channel final {
+        struct sender : public waiter_node {
+            T *value = nullptr;
+            bool delivered = false;
+        };
+        struct receiver : public waiter_node {
+            std::optional<T> value = {};
+        };
+
+        std::size_t max_size, head = {}, count = {};
+        std::unique_ptr<std::optional<T>[]> buffer;
+        bool is_closed = false;
+        waiter_list senders, receivers;
+        executor *exec = nullptr;
+
+
+        void wake(waiter_node &n) { resume_on(exec, n.handle); }
+
+        /// Buffer or hand off a value if that can be done without waiting
+        bool offer(T &value) {
+            if (auto *r = static_cast<receiver *>(receivers.pop_front()); r) {
+                r->value.emplace(std::move(value));
+                wake(*r);
+                return true;
+            } else if (count < max_size) {
+                buffer[(head + count++) % max_size].emplace(std::move(value));
+                return true;
+            } else {
+                return false;
+            }
+        }
+        /// Take a value if that can be done without waiting
+        bool take(std::optional<T> &into) {
+            auto *const s = static_cast<sender *>(senders.pop_front());
+            if (count) {
+                into.emplace(std::move(*buffer[head]));
+                buffer[head].reset();
+                head = (head + 1) % max_size;
+                --count;
+                if (s) {
+                    buffer[(head + count++) % max_size].emplace(
+                            std::move(*s->value));
+                }
+            } else if (s) {
+                into.emplace(std::move(*s->value));
+            } else {
+                return false;
+            }
+            if (s) {
+                s->delivered = true;
+                wake(*s);
+            }
+            return true;
+        }
+
+
+      public:
+        using value_type = T;
+
+        explicit channel(std::size_t const capacity)
+        : max_size{capacity},
+          buffer{std::make_unique<std::optional<T>[]>(capacity)} {}
+        channel(std::size_t const capacity, executor &e)
+        : channel{capacity} {
+            exec = &e;
+        }
+        channel(channel const &) = delete;
+        channel(channel &&) = delete;
+        channel &operator=(channel const &) = delete;
+        channel &operator=(channel &&) = delete;
+
+
+        /// ### Query the channel
+        [[nodiscard]] std::size_t capacity() const noexcept { return max_size; }
+        [[nodiscard]] std::size_t size() const noexcept { return count; }
+        [[nodiscard]] bool closed() const noexcept { return is_closed; }
+
+
+        /// ### Send a value
+        /**
+         * The awaitable returns true if the value was accepted by the channel
+         * and false if the channel was closed before it could be.
+         */
+        auto send(T t) {
+            struct awaitable {
+                awaitable(channel &c, T t) : ch{c}, value{std::move(t)} {}
+                awaitable(awaitable const &) = delete;
+                awaitable(awaitable &&) = delete;
+                ~awaitable() { ch.senders.remove(node); }
+
+                awaitable &operator=(awaitable const &) = delete;
+                awaitable &operator=(awaitable &&) = delete;
+
+
+                channel &ch;
+                T value;
+                sender node = {};
+                bool sent = false;
+
+
+                bool await_ready() {
+                    if (ch.is_closed) {
+                        return true;
+                    } else {
+                        return sent = ch.offer(value);
+                    }
+                }
+                void await_suspend(std::coroutine_handle<> h) noexcept {
+                    node.handle = h;
+                    node.value = &value;
+                    ch.senders.push_back(node);
+                }
+                bool await_resume() const noexcept {
+                    return sent or node.delivered;
+                }
+            };
+            return awaitable{*this, std::move(t)};
+        }
+
+
+        /// ### Receive a value
+        /// The awaitable returns an empty value once the channel is closed
+        /// and drained
+        auto receive() {
+            struct awaitable {
+                explicit awaitable(channel &c) : ch{c} {}
+                awaitable(awaitable const &) = delete;
+                awaitable(awaitable &&) = delete;
+                ~awaitable() { ch.receivers.remove(node); }
+
+                awaitable &operator=(awaitable const &) = delete;
+                awaitable &operator=(awaitable &&) = delete;
+
+
+                channel &ch;
+                receiver node = {};
+
+
+                bool await_ready() {
+                    return ch.take(node.value) or ch.is_closed;
+                }
+                void await_suspend(std::coroutine_handle<> h) noexcept {
+                    node.handle = h;
+                    ch.receivers.push_back(node);
+                }
+                std::optional<T> await_resume() {
+                    return std::move(node.value);
+                }
+            };
+            return awaitable{*this};
+        }
+
+
+        /// ### Close the channel
+        /// All waiting senders and receivers are woken
+        void close() {
+            is_closed = true;
+            while (auto *r = receivers.pop_front()) { wake(*r); }
+            while (auto *s = senders.pop_front()) { wake(*s); }
+        }
+
+
+        /// ### Return a stream of the values received from the channel
+        /// The stream ends when the channel is closed and drained
+        coro::stream<T> stream() {
+            while (auto v = co_await receive()) { co_yield std::move(*v); }
+        }
+    };
+
+
+}
@@ -104,4 +104,23 @@ namespace felspar::coro {
     };
 
 
+    /// ## The awaiter for an awaitable
+    /**
+     * Returns what `co_await` would use to suspend on the awaitable, so that
+     * it can be wrapped by another awaitable. Types with an `operator co_await`
+     * member have it called (as an rvalue if the awaitable was passed as an
+     * rvalue), anything else is taken to already be an awaiter.
+     */
+    template<typename A>
+    auto get_awaiter(A &&a) {
+        if constexpr (requires { std::forward<A>(a).operator co_await(); }) {
+            return std::forward<A>(a).operator co_await();
+        } else {
+            return std::forward<A>(a);
+        }
+    }
+    template<typename A>
+    using awaiter_type = decltype(get_awaiter(std::declval<A>()));
+
+
 }
@@ -0,0 +1,30 @@
+#pragma once
+
+
+#include <utility>
+
+
+namespace felspar::coro {
+
+
+    /// ## Yield every element of another stream or generator
+    /**
+     * `co_yield elements_of(inner)` hands control to the inner coroutine
+     * until it has finished, with each of its values going straight to the
+     * outermost consumer. The outer coroutine carries on from the `co_yield`
+     * once the inner one completes, and any exception it throws is re-thrown
+     * there. However deeply these are nested each value costs the same as
+     * yielding it directly.
+     *
+     * Only a reference to the inner coroutine is kept, which is fine for
+     * temporaries as they live until the end of the `co_yield`.
+     */
+    template<typename R>
+    struct elements_of {
+        R range;
+    };
+    template<typename R>
+    elements_of(R &&) -> elements_of<R &&>;
+
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+
+#include <felspar/coro/coroutine.hpp>
+
+
+namespace felspar::coro {
+
+
+    /// ## Executors
+    /**
+     * An executor decides when a continuation is run. Types that would
+     * otherwise resume waiting coroutines directly from inside the caller's
+     * stack (for example the `bus`, `future` and `cancellable`) can be given an
+     * executor, in which case the continuations are posted to it instead.
+     */
+    class executor {
+      public:
+        executor() = default;
+        executor(executor const &) = delete;
+        executor(executor &&) = delete;
+        virtual ~executor() = default;
+
+        executor &operator=(executor const &) = delete;
+        executor &operator=(executor &&) = delete;
+
+
+        /// ### Schedule a continuation
+        virtual void post(std::coroutine_handle<>) = 0;
+
+
+        /// ### The executor running continuations on this thread
+        /// Returns `nullptr` if there isn't one
+        static executor *current() noexcept { return current_executor(); }
+
+
+      protected:
+        /// ### Mark this executor as current whilst it runs continuations
+        class running final {
+            executor *previous;
+
+          public:
+            explicit running(executor &e)
+            : previous{std::exchange(current_executor(), &e)} {}
+            running(running const &) = delete;
+            running &operator=(running const &) = delete;
+            ~running() { current_executor() = previous; }
+        };
+
+
+      private:
+        static executor *&current_executor() noexcept {
+            thread_local executor *e = nullptr;
+            return e;
+        }
+    };
+
+
+    /// ## Resume a continuation
+    /// Posts the continuation to the executor if there is one, otherwise
+    /// resumes it immediately
+    inline void resume_on(executor *const e, std::coroutine_handle<> const h) {
+        if (e) {
+            e->post(h);
+        } else {
+            h.resume();
+        }
+    }
+
+
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+
+
+namespace felspar::coro {
+
+
+    /// ## Recycling allocator for coroutine frames
+    /**
+     * A stateless allocator that can be given as the `Allocator` parameter of
+     * the coroutine types, e.g. `task<int, frame_pool<>>`. Requests are
+     * rounded up to a multiple of `alignof(std::max_align_t)` and each size
+     * up to `MaxSize` has its own free list, so a frame that is released is
+     * handed straight back out for the next frame of the same size. Larger
+     * requests go to the global `operator new`.
+     *
+     * The free lists are thread local, so the common case takes no locks.
+     * Frames may be released on a different thread from the one that
+     * allocated them: they go onto the releasing thread's list, and once a
+     * list holds more than two batches a batch is passed to a shared depot,
+     * from which any thread that runs out takes a batch before falling back
+     * to `operator new`. A thread's lists are passed to the depot when it
+     * exits, and the depot frees what it holds at program exit.
+     *
+     * Each instantiation has its own free lists.
+     */
+    template<std::size_t MaxSize = 1024, std::size_t Batch = 32>
+    class frame_pool final {
+        struct node {
+            node *next;
+            /// Only used by the first node of a batch in the depot
+            node *next_batch;
+        };
+
+        static constexpr std::size_t granularity =
+                alignof(std::max_align_t) < sizeof(node)
+                ? sizeof(node)
+                : alignof(std::max_align_t);
+        static constexpr std::size_t classes =
+                (MaxSize + granularity - 1) / granularity;
+        static_assert(classes > 0, "MaxSize is too small");
+        static_assert(Batch > 0, "The batch size must be at least one");
+        struct list {
+            node *head = nullptr;
+            std::size_t count = {};
+        };
+
+        static std::size_t class_of(std::size_t const bytes) noexcept {
+            return bytes <= granularity
+                    ? 0
+                    : (bytes + granularity - 1) / granularity - 1;
+        }
+
+        struct depot {
+            std::mutex mtx;
+            std::array<node *, classes> batches = {};
+
+            ~depot() {
+                for (auto batch : batches) {
+                    while (batch) {
+                        auto const next_batch = batch->next_batch;
+                        while (batch) {
+                            ::operator delete(std::exchange(batch, batch->next));
+                        }
+                        batch = next_batch;
+                    }
+                }
+            }
+
+            void give(std::size_t const index, node *const batch) {
+                std::scoped_lock _{mtx};
+                batch->next_batch = batches[index];
+                batches[index] = batch;
+            }
+            node *take(std::size_t const index) {
+                std::scoped_lock _{mtx};
+                auto const batch = batches[index];
+                if (batch) { batches[index] = batch->next_batch; }
+                return batch;
+            }
+        };
+        static depot &shared() {
+            static depot d;
+            return d;
+        }
+
+        struct cache {
+            depot &d = shared();
+            std::array<list, classes> lists = {};
+
+            ~cache() {
+                for (std::size_t index{}; index < classes; ++index) {
+                    if (lists[index].head) { d.give(index, lists[index].head); }
+                }
+            }
+        };
+        static cache &local() {
+            thread_local cache c;
+            return c;
+        }
+
+
+      public:
+        static constexpr std::size_t max_size = MaxSize;
+        static constexpr std::size_t batch_size = Batch;
+
+
+        /// ### Allocation
+        void *allocate(std::size_t const bytes) {
+            if (bytes > MaxSize) { return ::operator new(bytes); }
+            auto const index = class_of(bytes);
+            auto &l = local().lists[index];
+            if (not l.head) {
+                l.head = local().d.take(index);
+                for (auto n = l.head; n; n = n->next) { ++l.count; }
+            }
+            if (l.head) {
+                --l.count;
+                return std::exchange(l.head, l.head->next);
+            } else {
+                return ::operator new((index + 1) * granularity);
+            }
+        }
+        void deallocate(void *const ptr, std::size_t const bytes) {
+            if (bytes > MaxSize) { return ::operator delete(ptr); }
+            auto const index = class_of(bytes);
+            auto &l = local().lists[index];
+            l.head = new (ptr) node{l.head, nullptr};
+            if (++l.count > 2 * Batch) {
+                /// Pass the first `Batch` nodes to the depot
+                auto const batch = l.head;
+                auto last = batch;
+                for (std::size_t n{1}; n < Batch; ++n) { last = last->next; }
+                l.head = std::exchange(last->next, nullptr);
+                l.count -= Batch;
+                local().d.give(index, batch);
+            }
+        }
+    };
+
+
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+
+#include <felspar/coro/allocator.hpp>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <source_location>
+#include <tuple>
+#include <vector>
+
+
+namespace felspar::coro {
+
+
+    /// ## Coroutine frame statistics
+    /**
+     * Using `frame_statistics<Tag, Allocator>` as the allocator type of a
+     * coroutine counts its frames against `Tag`, and against the coroutine
+     * function that created them, and then allocates them using `Allocator`
+     * (which must be `void` or stateless, like a
+     * [`frame_pool`](./frame_pool.hpp)). A `snapshot` gives the counts for
+     * a tag, and `frame_site_snapshot` gives them for every coroutine
+     * function that has allocated a frame.
+     *
+     * The counting is only done if `FELSPAR_CORO_FRAME_STATISTICS` is
+     * defined. Otherwise frames are allocated by `Allocator` exactly as if it
+     * had been used directly, and the snapshots are always empty. The macro
+     * must be the same in every translation unit.
+     */
+    template<typename Tag = void, typename Allocator = void>
+    struct frame_statistics;
+
+#if defined FELSPAR_CORO_FRAME_STATISTICS
+    inline constexpr bool frame_statistics_enabled = true;
+#else
+    inline constexpr bool frame_statistics_enabled = false;
+#endif
+
+
+    /// ### The counts
+    /**
+     * Sizes are of the frames as requested by the compiler. The histogram has
+     * a bucket for each power of two from 16 bytes, with the last holding
+     * everything larger. High water marks are for the live counts.
+     */
+    struct frame_counts {
+        static constexpr std::size_t buckets = 16;
+
+        std::size_t allocations = {}, total_bytes = {};
+        std::size_t live = {}, live_bytes = {};
+        std::size_t high_water = {}, high_water_bytes = {};
+        std::array<std::size_t, buckets> histogram = {};
+
+        /// Bucket `b` counts frames of more than `2^(b+3)` bytes and at most
+        /// `2^(b+4)`
+        static std::size_t bucket_of(std::size_t const bytes) noexcept {
+            auto const width = static_cast<std::size_t>(
+                    std::bit_width((bytes > 16u ? bytes : 16u) - 1u));
+            return width - 4u < buckets ? width - 4u : buckets - 1u;
+        }
+    };
+    struct frame_site_counts {
+        std::source_location location;
+        frame_counts counts;
+    };
+
+
+    namespace detail {
+        class frame_counters {
+            std::atomic<std::size_t> allocations = {}, total_bytes = {},
+                                     live = {}, live_bytes = {},
+                                     high_water = {}, high_water_bytes = {};
+            std::array<std::atomic<std::size_t>, frame_counts::buckets>
+                    histogram = {};
+
+            static void raise(
+                    std::atomic<std::size_t> &mark,
+                    std::size_t const value) noexcept {
+                auto seen = mark.load(std::memory_order_relaxed);
+                while (seen < value
+                       and not mark.compare_exchange_weak(
+                               seen, value, std::memory_order_relaxed)) {}
+            }
+
+          public:
+            void allocated(std::size_t const bytes) noexcept {
+                allocations.fetch_add(1, std::memory_order_relaxed);
+                total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+                histogram[frame_counts::bucket_of(bytes)].fetch_add(
+                        1, std::memory_order_relaxed);
+                raise(high_water,
+                      live.fetch_add(1, std::memory_order_relaxed) + 1);
+                raise(high_water_bytes,
+                      live_bytes.fetch_add(bytes, std::memory_order_relaxed)
+                              + bytes);
+            }
+            void released(std::size_t const bytes) noexcept {
+                live.fetch_sub(1, std::memory_order_relaxed);
+                live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+            }
+
+            frame_counts snapshot() const noexcept {
+                frame_counts counts;
+                counts.allocations = allocations.load(std::memory_order_relaxed);
+                counts.total_bytes = total_bytes.load(std::memory_order_relaxed);
+                counts.live = live.load(std::memory_order_relaxed);
+                counts.live_bytes = live_bytes.load(std::memory_order_relaxed);
+                counts.high_water = high_water.load(std::memory_order_relaxed);
+                counts.high_water_bytes =
+                        high_water_bytes.load(std::memory_order_relaxed);
+                for (std::size_t b{}; b < frame_counts::buckets; ++b) {
+                    counts.histogram[b] =
+                            histogram[b].load(std::memory_order_relaxed);
+                }
+                return counts;
+            }
+        };
+
+
+        /// Counters for each coroutine function, found by its location
+        class frame_sites {
+            struct site {
+                std::source_location location;
+                frame_counters counters = {};
+            };
+            std::mutex mtx;
+            std::deque<site> sites;
+            std::map<std::tuple<char const *, std::uint_least32_t, char const *>,
+                     site *>
+                    index;
+
+            frame_counters &registered(std::source_location const &loc) {
+                std::scoped_lock _{mtx};
+                auto &found =
+                        index[{loc.file_name(), loc.line(), loc.function_name()}];
+                if (not found) { found = &sites.emplace_back(loc); }
+                return found->counters;
+            }
+
+          public:
+            static frame_sites &instance() {
+                static frame_sites s;
+                return s;
+            }
+
+            /// Each thread caches the sites it has used, so the lock is only
+            /// taken the first time a thread allocates from a site (or when
+            /// two sites it uses share a cache slot). Sites are never
+            /// removed, so the cached counters stay valid.
+            frame_counters &find(std::source_location const &loc) {
+                struct cached {
+                    char const *file = nullptr, *function = nullptr;
+                    std::uint_least32_t line = {};
+                    frame_counters *counters = nullptr;
+                };
+                thread_local std::array<cached, 64> cache = {};
+                auto const hash =
+                        reinterpret_cast<std::uintptr_t>(loc.function_name())
+                        ^ loc.line();
+                auto &c = cache[(hash ^ (hash >> 6)) % cache.size()];
+                if (not c.counters or c.function != loc.function_name()
+                    or c.line != loc.line() or c.file != loc.file_name()) {
+                    c = {loc.file_name(), loc.function_name(), loc.line(),
+                         &registered(loc)};
+                }
+                return *c.counters;
+            }
+            std::vector<frame_site_counts> snapshot() {
+                std::scoped_lock _{mtx};
+                std::vector<frame_site_counts> counts;
+                counts.reserve(sites.size());
+                for (auto const &s : sites) {
+                    counts.push_back({s.location, s.counters.snapshot()});
+                }
+                return counts;
+            }
+        };
+    }
+
+
+#if defined FELSPAR_CORO_FRAME_STATISTICS
+    namespace detail {
+        /// Shared by every allocator using the tag
+        template<typename Tag>
+        frame_counters &tag_counters() {
+            static frame_counters c;
+            return c;
+        }
+    }
+    template<typename Tag, typename Allocator>
+    struct frame_statistics {
+        static frame_counts snapshot() {
+            return detail::tag_counters<Tag>().snapshot();
+        }
+    };
+    inline std::vector<frame_site_counts> frame_site_snapshot() {
+        return detail::frame_sites::instance().snapshot();
+    }
+
+
+    /// ### Counting allocations
+    /**
+     * The coroutine function's counters are stored in front of the frame so
+     * that they can be found again when it is released. The default argument
+     * gives the location of the coroutine function.
+     */
+    template<typename Tag, typename Allocator>
+    struct promise_allocator_impl<frame_statistics<Tag, Allocator>> {
+        static_assert(
+                std::is_void_v<Allocator> or stateless_allocator<Allocator>,
+                "The allocator must be void or stateless");
+
+        struct allocation {
+            detail::frame_counters *site;
+        };
+        static constexpr std::size_t allocator_block_size =
+                felspar::memory::block_size(
+                        sizeof(allocation), alignof(std::max_align_t));
+
+        void *operator new(
+                std::size_t const psize,
+                std::source_location const &loc =
+                        std::source_location::current()) {
+            auto const total = allocator_block_size + psize;
+            std::byte *base;
+            if constexpr (std::is_void_v<Allocator>) {
+                base = static_cast<std::byte *>(::operator new(total));
+            } else {
+                base = static_cast<std::byte *>(Allocator{}.allocate(total));
+            }
+            auto &site = detail::frame_sites::instance().find(loc);
+            new (base) allocation{&site};
+            site.allocated(psize);
+            detail::tag_counters<Tag>().allocated(psize);
+            return base + allocator_block_size;
+        }
+        void operator delete(void *const ptr, std::size_t const psize) {
+            auto const base =
+                    static_cast<std::byte *>(ptr) - allocator_block_size;
+            reinterpret_cast<allocation *>(base)->site->released(psize);
+            detail::tag_counters<Tag>().released(psize);
+            if constexpr (std::is_void_v<Allocator>) {
+                ::operator delete(base);
+            } else {
+                Allocator{}.deallocate(base, allocator_block_size + psize);
+            }
+        }
+    };
+#else
+    template<typename Tag, typename Allocator>
+    struct frame_statistics {
+        static frame_counts snapshot() { return {}; }
+    };
+    inline std::vector<frame_site_counts> frame_site_snapshot() { return {}; }
+
+    template<typename Tag, typename Allocator>
+    struct promise_allocator_impl<frame_statistics<Tag, Allocator>> :
+    public promise_allocator_impl<Allocator> {};
+#endif
+
+
+}
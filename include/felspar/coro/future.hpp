@@ -2,10 +2,11 @@
 
 
 #include <felspar/coro/coroutine.hpp>
+#include <felspar/coro/executor.hpp>
+#include <felspar/coro/waiter_list.hpp>
 #include <felspar/exceptions.hpp>
 
 #include <optional>
-#include <vector>
 
 
 namespace felspar::coro {
@@ -24,17 +25,26 @@ namespace felspar::coro {
      *
      * The value can be set and read from non-coroutines as well. The value can
      * only be set once.
+     *
+     * If the future is given an [executor](./executor.hpp) then the waiting
+     * coroutines are posted to it when the value is set rather than being
+     * resumed from inside `set_value`.
      */
     template<typename T>
     class future {
         std::optional<T> m_value;
-        std::vector<std::coroutine_handle<>> continuations;
+        waiter_list continuations;
+        executor *exec = nullptr;
 
 
       public:
         using value_type = T;
 
 
+        future() = default;
+        explicit future(executor &e) : exec{&e} {}
+
+
         /// ### Query the future
         bool has_value() const noexcept { return m_value.has_value(); }
         explicit operator bool() const noexcept { return has_value(); }
@@ -68,27 +78,22 @@ namespace felspar::coro {
                 awaitable(awaitable const &) = delete;
                 // TODO We could be movable
                 awaitable(awaitable &&) = delete;
-                ~awaitable() {
-                    if (mine) { std::erase(fut.continuations, mine); }
-                }
+                ~awaitable() { fut.continuations.remove(node); }
 
                 awaitable &operator=(awaitable const &) = delete;
                 awaitable &operator=(awaitable &&) = delete;
 
 
                 coro::future<value_type> &fut;
-                std::coroutine_handle<> mine = {};
+                waiter_node node = {};
 
 
                 bool await_ready() const noexcept { return fut.has_value(); }
-                void await_suspend(std::coroutine_handle<> h) {
-                    mine = h;
-                    fut.continuations.push_back(h);
-                }
-                value_type &await_resume() {
-                    mine = {};
-                    return *fut.m_value;
+                void await_suspend(std::coroutine_handle<> h) noexcept {
+                    node.handle = h;
+                    fut.continuations.push_back(node);
                 }
+                value_type &await_resume() { return *fut.m_value; }
             };
             return awaitable{*this};
         }
@@ -104,21 +109,27 @@ namespace felspar::coro {
                         "The future already has a value set", loc};
             }
             m_value = std::move(t);
-            for (auto h : continuations) { h.resume(); }
-            continuations = {};
+            while (auto *n = continuations.pop_front()) {
+                resume_on(exec, n->handle);
+            }
         }
     };
 
     template<>
     class future<void> {
         bool m_has_value = false;
-        std::vector<std::coroutine_handle<>> continuations;
+        waiter_list continuations;
+        executor *exec = nullptr;
 
 
       public:
         using value_type = void;
 
 
+        future() = default;
+        explicit future(executor &e) : exec{&e} {}
+
+
         /// ### Query the future
         bool has_value() const noexcept { return m_has_value; }
         explicit operator bool() const noexcept { return has_value(); }
@@ -148,24 +159,22 @@ namespace felspar::coro {
                 awaitable(awaitable const &) = delete;
                 // TODO We could be movable
                 awaitable(awaitable &&) = delete;
-                ~awaitable() {
-                    if (mine) { std::erase(fut.continuations, mine); }
-                }
+                ~awaitable() { fut.continuations.remove(node); }
 
                 awaitable &operator=(awaitable const &) = delete;
                 awaitable &operator=(awaitable &&) = delete;
 
 
                 coro::future<void> &fut;
-                std::coroutine_handle<> mine = {};
+                waiter_node node = {};
 
 
                 bool await_ready() const noexcept { return fut.has_value(); }
-                void await_suspend(std::coroutine_handle<> h) {
-                    mine = h;
-                    fut.continuations.push_back(h);
+                void await_suspend(std::coroutine_handle<> h) noexcept {
+                    node.handle = h;
+                    fut.continuations.push_back(node);
                 }
-                void await_resume() noexcept { mine = {}; }
+                void await_resume() noexcept {}
             };
             return awaitable{*this};
         }
@@ -180,8 +189,9 @@ namespace felspar::coro {
                         "The future already has a value set", loc};
             }
             m_has_value = true;
-            for (auto h : continuations) { h.resume(); }
-            continuations = {};
+            while (auto *n = continuations.pop_front()) {
+                resume_on(exec, n->handle);
+            }
         }
     };
 
@@ -2,7 +2,10 @@
 
 
 #include <felspar/coro/allocator.hpp>
+#include <felspar/coro/batch.hpp>
 #include <felspar/coro/coroutine.hpp>
+#include <felspar/coro/elements_of.hpp>
+#include <felspar/exceptions.hpp>
 #include <felspar/memory/holding_pen.hpp>
 
 #include <exception>
@@ -13,6 +16,8 @@ namespace felspar::coro {
 
     template<typename Y, typename Allocator>
     struct generator_promise;
+    template<typename Y, typename Allocator, typename... Stages>
+    class fused_generator;
 
 
     /// ## Generator
@@ -23,6 +28,8 @@ namespace felspar::coro {
     template<typename Y, typename Allocator = void>
     class FELSPAR_CORO_CRT generator final {
         friend struct generator_promise<Y, Allocator>;
+        template<typename, typename, typename...>
+        friend class fused_generator;
         using handle_type =
                 typename generator_promise<Y, Allocator>::handle_type;
         handle_type coro;
@@ -47,7 +54,7 @@ namespace felspar::coro {
 
             iterator() : coro{} {}
             iterator(generator *s) : coro{std::move(s->coro)} {
-                coro.resume();
+                coro.promise().resume_point().resume();
                 throw_if_needed();
             }
 
@@ -71,7 +78,9 @@ namespace felspar::coro {
             }
 
             auto &operator++() {
-                coro.resume();
+                if (not coro.promise().take_pending()) {
+                    coro.promise().resume_point().resume();
+                }
                 throw_if_needed();
                 if (not coro.promise().value) { coro = {}; }
                 return *this;
@@ -96,32 +105,145 @@ namespace felspar::coro {
 
         /// Fetching values. Returns an empty `optional` when completed.
         memory::holding_pen<Y> next() {
-            coro.resume();
+            if (not coro.promise().take_pending()) {
+                coro.promise().resume_point().resume();
+            }
             if (coro.promise().eptr) {
                 std::rethrow_exception(coro.promise().eptr);
             } else {
                 return std::move(coro.promise().value).transfer_out();
             }
         }
+
+        /// Fetching many values at once
+        /**
+         * Values are moved into the buffer as they are yielded, and the
+         * generator is only suspended once it is full or the generator has
+         * completed. Returns the number of values placed in the buffer, which
+         * is less than its size only once the generator has completed.
+         */
+        std::size_t next_batch(
+                std::span<Y> buffer,
+                std::source_location const &loc =
+                        std::source_location::current()) {
+            static_assert(
+                    batch_buffer<Y>::batchable,
+                    "next_batch needs a move assignable value type");
+            if (buffer.empty()) {
+                throw stdexcept::logic_error{
+                        "The buffer for next_batch must not be empty", loc};
+            }
+            auto &p = coro.promise();
+            p.start_batch(buffer);
+            if (not p.full() and not coro.done()) {
+                p.resume_point().resume();
+            }
+            auto const count = p.end_batch();
+            if (p.eptr) { std::rethrow_exception(p.eptr); }
+            return count;
+        }
     };
 
 
     template<typename Y, typename Allocator>
-    struct generator_promise : private promise_allocator_impl<Allocator> {
-        using promise_allocator_impl<Allocator>::operator new;
-        using promise_allocator_impl<Allocator>::operator delete;
+    struct generator_promise :
+    private promise_allocator_impl<Allocator>,
+            public batch_buffer<Y> {
+        using allocator_impl = promise_allocator_impl<Allocator>;
+        using allocator_impl::operator new;
+        using allocator_impl::operator delete;
 
         memory::holding_pen<Y> value = {};
         std::exception_ptr eptr = {};
 
         using handle_type = unique_handle<generator_promise>;
 
+        /// Whilst delegating to another generator with `elements_of`, the
+        /// outermost promise is the `root` and it holds the `innermost`
+        /// coroutine which is the one that is to be resumed
+        generator_promise *root = this, *parent = nullptr;
+        std::coroutine_handle<> innermost = {};
+
+        std::coroutine_handle<> resume_point() {
+            if (innermost) {
+                return innermost;
+            } else {
+                return std::coroutine_handle<generator_promise>::from_promise(
+                        *this);
+            }
+        }
+
         template<typename A>
         std::suspend_always await_transform(A &&) = delete; // Use stream
 
         auto yield_value(Y y) {
-            value.emplace(std::move(y));
-            return std::suspend_always{};
+            return on_resume<allocator_impl>(*this, deliver_value(std::move(y)));
+        }
+        auto yield_value(std::span<Y> ys) {
+            return on_resume<allocator_impl>(*this, deliver_values(ys));
+        }
+        /// Values are always delivered by the root generator's promise
+        conditional_continuation deliver_value(Y y) {
+            if (root != this) {
+                return root->deliver_value(std::move(y));
+            } else if (this->sink) {
+                return conditional_continuation{
+                        {}, this->sink->push(std::move(y)).suspend()};
+            } else if (this->batching()) {
+                this->add(std::move(y));
+                return conditional_continuation{{}, this->full()};
+            } else {
+                value.emplace(std::move(y));
+                return conditional_continuation{{}, true};
+            }
+        }
+        conditional_continuation deliver_values(std::span<Y> ys) {
+            if (root != this) { return root->deliver_values(ys); }
+            this->pending = ys;
+            if (this->sink) {
+                return conditional_continuation{
+                        {}, this->feed_pending().suspend()};
+            } else if (this->batching()) {
+                this->drain();
+                return conditional_continuation{{}, this->full()};
+            } else {
+                return conditional_continuation{{}, take_pending()};
+            }
+        }
+        /// Delegate to another generator
+        template<typename G>
+        requires std::same_as<std::remove_cvref_t<G>, generator<Y, Allocator>>
+        auto yield_value(elements_of<G> e) {
+            struct awaitable {
+                generator_promise &outer;
+                handle_type &inner;
+
+                bool await_ready() const noexcept { return inner.done(); }
+                std::coroutine_handle<>
+                        await_suspend(std::coroutine_handle<>) noexcept {
+                    inner.promise().root = outer.root;
+                    inner.promise().parent = &outer;
+                    outer.root->innermost = inner.get();
+                    return inner.get();
+                }
+                void await_resume() {
+                    if (auto eptr = inner.promise().eptr) {
+                        std::rethrow_exception(eptr);
+                    }
+                }
+            };
+            return on_resume<allocator_impl>(
+                    *this, awaitable{*this, e.range.coro});
+        }
+        /// Move the next of any pending values into `value`
+        bool take_pending() {
+            if (this->pending.empty()) {
+                return false;
+            } else {
+                value.emplace(std::move(this->pending.front()));
+                this->pending = this->pending.subspan(1);
+                return true;
+            }
         }
         void unhandled_exception() { eptr = std::current_exception(); }
 
@@ -130,8 +252,22 @@ namespace felspar::coro {
         auto get_return_object() {
             return generator<Y, Allocator>{handle_type::from_promise(*this)};
         }
-        auto initial_suspend() const noexcept { return std::suspend_always{}; }
-        auto final_suspend() const noexcept { return std::suspend_always{}; }
+        auto initial_suspend() noexcept {
+            return on_resume<allocator_impl>(*this, std::suspend_always{});
+        }
+        /// A delegated generator returns to its parent
+        auto final_suspend() noexcept {
+            on_final<allocator_impl>(*this);
+            if (parent) {
+                auto const h =
+                        std::coroutine_handle<generator_promise>::from_promise(
+                                *parent);
+                root->innermost = parent == root ? nullptr : h;
+                return symmetric_continuation{h};
+            } else {
+                return symmetric_continuation{};
+            }
+        }
     };
 
 
@@ -0,0 +1,128 @@
+#pragma once
+
+
+#include <felspar/coro/executor.hpp>
+#include <felspar/coro/stream.hpp>
+#include <felspar/coro/waiter_list.hpp>
+
+#include <functional>
+#include <optional>
+#include <unordered_map>
+
+
+namespace felspar::coro {
+
+
+    /// ## A data distribution bus with a topic per key
+    /**
+     * Works like the [bus](./bus.hpp), but each value is pushed with a key
+     * and is only delivered to the coroutines waiting on that key. Each key
+     * has its own list of waiting coroutines, so a push only touches the
+     * coroutines that want the value. The last value pushed for each key is
+     * kept and can be read at any time.
+     *
+     * A key's topic is created the first time it is waited on or pushed to,
+     * and lives as long as the bus does. There is no thread synchronisation.
+     */
+    template<typename K, typename T, typename Hash = std::hash<K>>
+    class keyed_bus final {
+        struct topic {
+            std::optional<T> current;
+            waiter_list waiting;
+        };
+        std::unordered_map<K, topic, Hash> topics;
+        executor *exec = nullptr;
+
+        topic const *find(K const &key) const {
+            auto const pos = topics.find(key);
+            return pos == topics.end() ? nullptr : &pos->second;
+        }
+
+      public:
+        using key_type = K;
+        using value_type = T;
+
+        keyed_bus() = default;
+        explicit keyed_bus(executor &e) : exec{&e} {}
+        keyed_bus(keyed_bus &&) = default;
+        keyed_bus(keyed_bus const &) = delete;
+
+        keyed_bus &operator=(keyed_bus &&) = default;
+        keyed_bus &operator=(keyed_bus const &) = delete;
+
+
+        /// ### Query the bus
+
+        /// #### Clients
+        /// Returns true if there is anything currently waiting on the key
+        bool has_clients(K const &key) const {
+            auto const *t = find(key);
+            return t and not t->waiting.empty();
+        }
+
+        /// #### The latest value for a key
+        /// This will be empty until the first value is pushed for the key
+        std::optional<T> const &latest(K const &key) const {
+            static std::optional<T> const none;
+            auto const *t = find(key);
+            return t ? t->current : none;
+        }
+
+
+        /// ### Return an awaitable for the next value for the key
+        FELSPAR_CORO_WRAPPER auto next(K const &key) {
+            struct FELSPAR_CORO_CRT awaitable {
+                awaitable(topic &tt) : t{tt} {}
+                awaitable(awaitable const &) = delete;
+                awaitable(awaitable &&) = delete;
+                ~awaitable() { t.waiting.remove(node); }
+
+                awaitable &operator=(awaitable const &) = delete;
+                awaitable &operator=(awaitable &&) = delete;
+
+
+                topic &t;
+                waiter_node node = {};
+
+
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<> h) noexcept {
+                    node.handle = h;
+                    t.waiting.push_back(node);
+                }
+                T &await_resume() { return *t.current; }
+            };
+            return awaitable{topics[key]};
+        }
+
+
+        /// ### Return a stream of values for the key
+        /**
+         * The stream will never terminate, but it is safe to delete so long as
+         * the deletion is not a result of a message sent to the stream. See the
+         * `push` member for more details
+         */
+        coro::stream<T> stream(K key) {
+            while (true) { co_yield (co_await next(key)); }
+        }
+
+
+        /// ### Publish a value to the coroutines waiting on the key
+        /**
+         * Returns the number of coroutines that received a copy of the message.
+         *
+         * Without an executor waiting coroutines are continued synchronously.
+         * This can lead to undefined behaviour if it is a coroutine that has
+         * pushed the value and the value causes the coroutine's stack frame to
+         * be destroyed.
+         */
+        std::size_t push(K const &key, T t) {
+            auto &tp = topics[key];
+            tp.current = std::move(t);
+            return tp.waiting.drain(
+                    [this](waiter_node &n) { resume_on(exec, n.handle); });
+        }
+    };
+
+
+}
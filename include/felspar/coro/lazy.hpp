@@ -23,8 +23,9 @@ namespace felspar::coro {
         ~lazy() = default;
 
         struct promise_type : private promise_allocator_impl<Allocator> {
-            using promise_allocator_impl<Allocator>::operator new;
-            using promise_allocator_impl<Allocator>::operator delete;
+            using allocator_impl = promise_allocator_impl<Allocator>;
+            using allocator_impl::operator new;
+            using allocator_impl::operator delete;
 
             std::exception_ptr eptr;
             std::optional<L> value;
@@ -40,16 +41,21 @@ namespace felspar::coro {
             void unhandled_exception() { eptr = std::current_exception(); }
             void return_value(L v) { value = std::move(v); }
 
-            auto initial_suspend() const noexcept {
-                return std::suspend_always{};
+            auto initial_suspend() noexcept {
+                return on_resume<allocator_impl>(*this, std::suspend_always{});
             }
-            auto final_suspend() const noexcept {
+            auto final_suspend() noexcept {
+                on_final<allocator_impl>(*this);
                 return std::suspend_always{};
             }
         };
         friend promise_type;
 
-        L operator()() {
+        /// Returns a copy of the value
+        L operator()() { return value(); }
+        /// Returns the value without copying it. The reference is valid for
+        /// as long as the `lazy` is
+        L const &value() {
             if (not coro.done()) { coro.resume(); }
             if (coro.promise().eptr) {
                 std::rethrow_exception(coro.promise().eptr);
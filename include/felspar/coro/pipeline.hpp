@@ -0,0 +1,463 @@
+#pragma once
+
+
+#include <felspar/coro/to_stream.hpp>
+
+#include <concepts>
+#include <functional>
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+
+namespace felspar::coro {
+
+
+    /// ## Pipeline stages
+    /**
+     * Each stage is called with a value and the rest of the pipeline, and
+     * returns whatever the rest of the pipeline returned when it passed a
+     * value on, or its own [`sink_status`](./batch.hpp) if it didn't. Its
+     * `output_type` member gives the type it passes on for a given input.
+     * Once the source has finished `flush` is called so that a stage holding
+     * on to values can pass on what remains.
+     */
+    struct pipeline_stage {
+        template<typename Next>
+        sink_status flush(Next &&) {
+            return {};
+        }
+    };
+    template<typename S>
+    concept fusable_stage = std::derived_from<S, pipeline_stage>;
+
+
+    /// ### `map`
+    template<typename F>
+    struct map_stage : public pipeline_stage {
+        F function;
+
+        template<typename V>
+        using output_type = std::remove_cvref_t<std::invoke_result_t<F &, V &&>>;
+
+        template<typename V, typename Next>
+        sink_status operator()(V &&v, Next &&next) {
+            return next(std::invoke(function, std::forward<V>(v)));
+        }
+    };
+    template<typename F>
+    inline auto map(F f) {
+        return map_stage<F>{{}, std::move(f)};
+    }
+
+
+    /// ### `filter`
+    template<typename P>
+    struct filter_stage : public pipeline_stage {
+        P predicate;
+
+        template<typename V>
+        using output_type = V;
+
+        template<typename V, typename Next>
+        sink_status operator()(V &&v, Next &&next) {
+            if (std::invoke(predicate, std::as_const(v))) {
+                return next(std::forward<V>(v));
+            } else {
+                return {};
+            }
+        }
+    };
+    template<typename P>
+    inline auto filter(P p) {
+        return filter_stage<P>{{}, std::move(p)};
+    }
+
+
+    /// ### `take`
+    /// The source isn't resumed again after the last value has been taken
+    struct take_stage : public pipeline_stage {
+        std::size_t count, taken = {};
+
+        template<typename V>
+        using output_type = V;
+
+        template<typename V, typename Next>
+        sink_status operator()(V &&v, Next &&next) {
+            if (taken >= count) { return {.stop = true}; }
+            auto status = next(std::forward<V>(v));
+            status.stop = status.stop or ++taken == count;
+            return status;
+        }
+    };
+    inline auto take(std::size_t const count) {
+        return take_stage{{}, count};
+    }
+
+
+    /// ### `take_while`
+    template<typename P>
+    struct take_while_stage : public pipeline_stage {
+        P predicate;
+        bool stopped = false;
+
+        template<typename V>
+        using output_type = V;
+
+        template<typename V, typename Next>
+        sink_status operator()(V &&v, Next &&next) {
+            if (stopped or not std::invoke(predicate, std::as_const(v))) {
+                stopped = true;
+                return {.stop = true};
+            } else {
+                return next(std::forward<V>(v));
+            }
+        }
+    };
+    template<typename P>
+    inline auto take_while(P p) {
+        return take_while_stage<P>{{}, std::move(p)};
+    }
+
+
+    /// ### `enumerate`
+    /// Pairs each value with its zero based position
+    struct enumerate_stage : public pipeline_stage {
+        std::size_t index = {};
+
+        template<typename V>
+        using output_type = std::pair<std::size_t, V>;
+
+        template<typename V, typename Next>
+        sink_status operator()(V &&v, Next &&next) {
+            return next(std::pair<std::size_t, std::remove_cvref_t<V>>{
+                    index++, std::forward<V>(v)});
+        }
+    };
+    inline auto enumerate() { return enumerate_stage{}; }
+
+
+    /// ### `chunk`
+    /**
+     * Groups values into vectors of the given size, the last of which may be
+     * shorter. The stage only learns what it holds once it is added to a
+     * pipeline, when `bind` turns it into a `chunk_buffer`.
+     */
+    template<typename V>
+    struct chunk_buffer : public pipeline_stage {
+        std::size_t size;
+        std::vector<V> values = {};
+
+        template<typename>
+        using output_type = std::vector<V>;
+
+        template<typename Next>
+        sink_status operator()(V &&v, Next &&next) {
+            if (values.empty()) { values.reserve(size); }
+            values.push_back(std::move(v));
+            if (values.size() == size) {
+                return next(std::exchange(values, {}));
+            } else {
+                return {};
+            }
+        }
+        template<typename Next>
+        sink_status flush(Next &&next) {
+            if (values.empty()) {
+                return {};
+            } else {
+                return next(std::exchange(values, {}));
+            }
+        }
+    };
+    struct chunk_stage : public pipeline_stage {
+        std::size_t size;
+
+        template<typename V>
+        auto bind() {
+            return chunk_buffer<V>{{}, size};
+        }
+    };
+    inline auto chunk(std::size_t const size) {
+        return chunk_stage{{}, size == 0 ? 1 : size};
+    }
+
+
+    /// Stages that need to know their input type are bound to it as they are
+    /// added to a pipeline
+    template<typename V, fusable_stage S>
+    inline auto bind_stage(S s) {
+        if constexpr (requires { s.template bind<V>(); }) {
+            return s.template bind<V>();
+        } else {
+            return s;
+        }
+    }
+
+
+    /// ## Fused pipelines
+    /**
+     * Holds the stages and the value they most recently produced. It is the
+     * sink installed in the source's promise whilst the consumer is waiting,
+     * so every stage runs directly inside the source's `co_yield` and the
+     * source only suspends when the last stage has a value or the pipeline
+     * has stopped.
+     */
+    template<typename V, typename... Stages>
+    struct pipeline_output {
+        using type = V;
+    };
+    template<typename V, typename S, typename... Stages>
+    struct pipeline_output<V, S, Stages...> {
+        using type = typename pipeline_output<
+                typename S::template output_type<V>,
+                Stages...>::type;
+    };
+
+    template<typename Y, typename... Stages>
+    class pipeline_stages : public yield_sink<Y> {
+      protected:
+        using output_type = typename pipeline_output<Y, Stages...>::type;
+
+        std::tuple<Stages...> stages;
+        memory::holding_pen<output_type> output = {};
+        bool stopped = false;
+        std::size_t flushed = {};
+
+        pipeline_stages(std::tuple<Stages...> s) : stages{std::move(s)} {}
+        pipeline_stages(pipeline_stages &&) = default;
+        ~pipeline_stages() = default;
+
+        sink_status push(Y &&y) override {
+            auto const status = feed<0>(std::move(y));
+            stopped = stopped or status.stop;
+            return status;
+        }
+
+        template<std::size_t I, typename V>
+        sink_status feed(V &&v) {
+            if constexpr (I == sizeof...(Stages)) {
+                output.emplace(std::forward<V>(v));
+                return {.deliver = true};
+            } else {
+                return std::get<I>(stages)(
+                        std::forward<V>(v), [this]<typename N>(N &&n) {
+                            return feed<I + 1>(std::forward<N>(n));
+                        });
+            }
+        }
+
+        /// Once the source has finished, flush the stages in order until one
+        /// of them produces a value. Returns false once they are all empty.
+        bool flush() {
+            while (flushed < sizeof...(Stages)) {
+                bool delivered = false;
+                [&]<std::size_t... I>(std::index_sequence<I...>) {
+                    ((I == flushed
+                      and (delivered = std::get<I>(stages)
+                                               .flush([this]<typename N>(
+                                                              N &&n) {
+                                                   return feed<I + 1>(
+                                                           std::forward<N>(n));
+                                               })
+                                               .deliver,
+                           true))
+                     or ...);
+                }(std::index_sequence_for<Stages...>{});
+                if (delivered) { return true; }
+                ++flushed;
+            }
+            return false;
+        }
+
+        auto append_stage(fusable_stage auto s) {
+            return std::tuple_cat(
+                    std::move(stages), std::tuple{std::move(s)});
+        }
+    };
+
+
+    /// ### A fused stream
+    /**
+     * The `next` awaitable only resumes the source stream, and the stages run
+     * on each value it yields before control comes back to the awaiting
+     * coroutine. Like a `stream` it returns an empty `holding_pen` once the
+     * source has completed (or a stage has stopped it) and everything held by
+     * the stages has been flushed.
+     */
+    template<typename Y, typename Allocator, typename... Stages>
+    class fused_stream final : private pipeline_stages<Y, Stages...> {
+        using stages_type = pipeline_stages<Y, Stages...>;
+        template<typename, typename, typename...>
+        friend class fused_stream;
+
+        stream<Y, Allocator> source;
+
+        auto &promise() { return source.yielding_coro.promise(); }
+        bool finished() { return this->stopped or promise().completed; }
+
+
+      public:
+        using value_type = typename stages_type::output_type;
+
+        fused_stream(stream<Y, Allocator> s, std::tuple<Stages...> st)
+        : stages_type{std::move(st)}, source{std::move(s)} {}
+
+
+        FELSPAR_CORO_WRAPPER auto next() {
+            struct FELSPAR_CORO_CRT awaitable {
+                fused_stream &fused;
+                ~awaitable() {
+                    fused.promise().sink = nullptr;
+                    fused.promise().continuation = {};
+                }
+
+                bool await_ready() {
+                    if (fused.finished()) { return true; }
+                    fused.promise().sink = &fused;
+                    if (fused.promise().feed_pending().deliver) {
+                        return true;
+                    } else {
+                        return fused.finished();
+                    }
+                }
+                auto await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                    fused.promise().continuation = awaiting;
+                    return fused.promise().resume_point();
+                }
+                memory::holding_pen<value_type> await_resume() {
+                    fused.promise().sink = nullptr;
+                    if (auto eptr = fused.promise().eptr) {
+                        std::rethrow_exception(eptr);
+                    }
+                    if (not fused.output and fused.finished()) {
+                        fused.flush();
+                    }
+                    return std::move(fused.output).transfer_out();
+                }
+            };
+            return awaitable{*this};
+        }
+
+
+        /// Add a further stage
+        template<fusable_stage S>
+        friend auto operator|(fused_stream &&f, S s) {
+            auto bound = bind_stage<value_type>(std::move(s));
+            return fused_stream<Y, Allocator, Stages..., decltype(bound)>{
+                    std::move(f.source), f.append_stage(std::move(bound))};
+        }
+    };
+    template<typename Y, typename A, fusable_stage S>
+    inline auto operator|(stream<Y, A> &&s, S stage) {
+        auto bound = bind_stage<Y>(std::move(stage));
+        return fused_stream<Y, A, decltype(bound)>{
+                std::move(s), std::tuple{std::move(bound)}};
+    }
+
+
+    /// ### A fused generator
+    /// Values may be fetched with `next` or iterated over.
+    template<typename Y, typename Allocator, typename... Stages>
+    class fused_generator final : private pipeline_stages<Y, Stages...> {
+        using stages_type = pipeline_stages<Y, Stages...>;
+        template<typename, typename, typename...>
+        friend class fused_generator;
+
+        generator<Y, Allocator> source;
+
+        auto &promise() { return source.coro.promise(); }
+        bool finished() { return this->stopped or source.coro.done(); }
+
+
+      public:
+        using value_type = typename stages_type::output_type;
+
+        fused_generator(generator<Y, Allocator> g, std::tuple<Stages...> st)
+        : stages_type{std::move(st)}, source{std::move(g)} {}
+
+
+        /// Fetching values. Returns an empty `holding_pen` when completed.
+        memory::holding_pen<value_type> next() {
+            if (not finished()) {
+                promise().sink = this;
+                if (not promise().feed_pending().deliver and not finished()) {
+                    promise().resume_point().resume();
+                }
+                promise().sink = nullptr;
+                if (promise().eptr) { std::rethrow_exception(promise().eptr); }
+            }
+            if (not this->output and finished()) { this->flush(); }
+            return std::move(this->output).transfer_out();
+        }
+
+
+        /// Iteration
+        class iterator {
+            friend class fused_generator;
+            fused_generator *fused;
+            memory::holding_pen<value_type> current;
+
+            iterator(fused_generator *f) : fused{f}, current{f->next()} {}
+
+          public:
+            using difference_type = std::ptrdiff_t;
+
+            value_type operator*() { return std::move(*current); }
+            auto &operator++() {
+                current = fused->next();
+                return *this;
+            }
+            void operator++(int) { ++*this; }
+
+            friend bool operator==(iterator const &i, std::default_sentinel_t) {
+                return not i.current;
+            }
+        };
+        auto begin() { return iterator{this}; }
+        auto end() { return std::default_sentinel; }
+
+
+        /// Add a further stage
+        template<fusable_stage S>
+        friend auto operator|(fused_generator &&f, S s) {
+            auto bound = bind_stage<value_type>(std::move(s));
+            return fused_generator<Y, Allocator, Stages..., decltype(bound)>{
+                    std::move(f.source), f.append_stage(std::move(bound))};
+        }
+    };
+    template<typename Y, typename A, fusable_stage S>
+    inline auto operator|(generator<Y, A> &&g, S stage) {
+        auto bound = bind_stage<Y>(std::move(stage));
+        return fused_generator<Y, A, decltype(bound)>{
+                std::move(g), std::tuple{std::move(bound)}};
+    }
+
+
+    /// ## Turning a pipeline back into a stream
+    /**
+     * Costs a single coroutine frame however many stages the pipeline has.
+     * Can be used either directly or at the end of a pipe, e.g.
+     * `numbers() | filter(odd) | map(square) | to_stream()`.
+     */
+    template<typename Y, typename A, typename... Stages>
+    inline stream<typename fused_stream<Y, A, Stages...>::value_type>
+            to_stream(fused_stream<Y, A, Stages...> s) {
+        while (auto v = co_await s.next()) { co_yield std::move(*v); }
+    }
+    template<typename Y, typename A, typename... Stages>
+    inline stream<typename fused_generator<Y, A, Stages...>::value_type>
+            to_stream(fused_generator<Y, A, Stages...> g) {
+        while (auto v = g.next()) { co_yield std::move(*v); }
+    }
+    struct to_stream_adaptor {};
+    inline to_stream_adaptor to_stream() { return {}; }
+    template<typename P>
+    inline auto operator|(P &&p, to_stream_adaptor)
+        requires requires { to_stream(std::forward<P>(p)); }
+    {
+        return to_stream(std::forward<P>(p));
+    }
+
+
+}
@@ -0,0 +1,252 @@
+#pragma once
+
+
+#include <felspar/coro/task.hpp>
+#include <felspar/coro/waiter_list.hpp>
+#include <felspar/exceptions.hpp>
+
+#include <exception>
+#include <functional>
+#include <limits>
+#include <vector>
+
+
+namespace felspar::coro {
+
+
+    /// ## Start coroutines that clean up after themselves
+    /**
+     * Like [`starter`](./starter.hpp), but each posted task is run by a small
+     * wrapper coroutine that is linked into an intrusive list. When the task
+     * completes the wrapper unlinks itself and frees both frames straight
+     * away, so there is no need to garbage collect, and the memory used is
+     * for the work that is still running, not for everything that has ever
+     * been posted. Posting and completion are O(1).
+     *
+     * Return values are discarded. Exceptions are passed to the error sink
+     * given to the constructor, or, if there isn't one, are held until the
+     * next `wait_for_all` re-throws the first of them.
+     *
+     * The number of coroutines running at once can be limited, with `spawn`
+     * suspending its caller until there is room for another and `try_post`
+     * returning false instead. `post` always starts the task.
+     *
+     * Destroying the starter destroys any coroutines still running.
+     */
+    template<typename Task = task<void>>
+    class reclaiming_starter {
+      public:
+        using task_type = Task;
+        using error_sink_type = std::function<void(std::exception_ptr)>;
+
+
+        /// ### Construction
+        reclaiming_starter() = default;
+        explicit reclaiming_starter(error_sink_type s) : sink{std::move(s)} {}
+        explicit reclaiming_starter(
+                std::size_t const max_in_flight, error_sink_type s = {})
+        : limit{max_in_flight}, sink{std::move(s)} {}
+
+        reclaiming_starter(reclaiming_starter const &) = delete;
+        reclaiming_starter &operator=(reclaiming_starter const &) = delete;
+
+        ~reclaiming_starter() { reset(); }
+
+
+        /// ### Start a new coroutine
+        template<typename... PArgs, typename... MArgs>
+        void post(task_type (*f)(PArgs...), MArgs &&...margs) {
+            static_assert(sizeof...(PArgs) == sizeof...(MArgs));
+            post(f(std::forward<MArgs>(margs)...));
+        }
+        template<typename N, typename... PArgs, typename... MArgs>
+        void post(N &o, task_type (N::*f)(PArgs...), MArgs &&...margs) {
+            static_assert(sizeof...(PArgs) == sizeof...(MArgs));
+            post((o.*f)(std::forward<MArgs>(margs)...));
+        }
+        void post(task_type t) {
+            auto h = run(*this, std::move(t)).coro;
+            running.push_back(h.promise().node);
+            ++live;
+            h.resume();
+        }
+
+
+        /// ### Start a new coroutine if there is room for it
+        /**
+         * Returns false, dropping the task without starting it, if
+         * `max_in_flight` coroutines are already running or there are
+         * coroutines waiting in `spawn`.
+         */
+        [[nodiscard]] bool try_post(task_type t) {
+            if (has_room()) {
+                post(std::move(t));
+                return true;
+            } else {
+                return false;
+            }
+        }
+
+
+        /// ### Start a new coroutine once there is room for it
+        /**
+         * The awaiting coroutine is suspended until fewer than
+         * `max_in_flight` coroutines are running, and is then continued
+         * after the task has been started. Waiting coroutines are admitted in
+         * the order they started waiting.
+         */
+        FELSPAR_CORO_WRAPPER auto spawn(task_type t) {
+            struct FELSPAR_CORO_CRT awaitable : public waiter_node {
+                reclaiming_starter &s;
+                task_type t;
+                bool admitted = false;
+
+                awaitable(reclaiming_starter &rs, task_type tt)
+                : s{rs}, t{std::move(tt)} {}
+                awaitable(awaitable const &) = delete;
+                awaitable &operator=(awaitable const &) = delete;
+                ~awaitable() { s.admission.remove(*this); }
+
+                bool await_ready() const noexcept { return s.has_room(); }
+                void await_suspend(std::coroutine_handle<> h) noexcept {
+                    handle = h;
+                    s.admission.push_back(*this);
+                }
+                void await_resume() {
+                    if (handle) { --s.admitting; }
+                    s.post(std::move(t));
+                }
+            };
+            return awaitable{*this, std::move(t)};
+        }
+
+
+        /// ### The number of coroutines still running
+        [[nodiscard]] std::size_t size() const noexcept { return live; }
+        [[nodiscard]] bool empty() const noexcept { return live == 0; }
+        [[nodiscard]] std::size_t max_in_flight() const noexcept {
+            return limit;
+        }
+
+
+        /// ### Wait for all coroutines to complete
+        /**
+         * Including any posted whilst waiting. Re-throws the first held
+         * exception, if there is one. Only one coroutine may wait at a time.
+         */
+        task<void> wait_for_all(
+                std::source_location loc = std::source_location::current()) {
+            if (idle) {
+                throw stdexcept::logic_error{
+                        "Only one coroutine can wait on a reclaiming_starter",
+                        loc};
+            }
+            struct awaitable {
+                reclaiming_starter &s;
+                bool await_ready() const noexcept { return s.empty(); }
+                void await_suspend(std::coroutine_handle<> h) noexcept {
+                    s.idle = h;
+                }
+                void await_resume() const noexcept {}
+            };
+            co_await awaitable{*this};
+            if (not errors.empty()) {
+                auto first = std::move(errors.front());
+                errors.clear();
+                std::rethrow_exception(first);
+            }
+        }
+
+
+        /// ### Delete all coroutines
+        /**
+         * Calling this from any of the running coroutines will invoke undefined
+         * behaviour.
+         */
+        void reset() {
+            idle = {};
+            while (auto n = running.front()) { n->handle.destroy(); }
+        }
+
+
+      private:
+        struct runner {
+            struct promise_type {
+                reclaiming_starter &owner;
+                waiter_node node = {};
+
+                promise_type(reclaiming_starter &s, task_type &) : owner{s} {
+                    node.handle =
+                            std::coroutine_handle<promise_type>::from_promise(
+                                    *this);
+                }
+                ~promise_type() {
+                    owner.running.remove(node);
+                    --owner.live;
+                }
+
+                runner get_return_object() {
+                    return {std::coroutine_handle<promise_type>::from_promise(
+                            *this)};
+                }
+                auto initial_suspend() const noexcept {
+                    return std::suspend_always{};
+                }
+                auto final_suspend() const noexcept {
+                    /// Frees the frame, and then continues `wait_for_all` if
+                    /// this was the last one
+                    struct awaitable {
+                        bool await_ready() const noexcept { return false; }
+                        std::coroutine_handle<> await_suspend(
+                                std::coroutine_handle<promise_type> h) noexcept {
+                            auto &s = h.promise().owner;
+                            h.destroy();
+                            if (s.live + s.admitting < s.limit
+                                and not s.admission.empty()) {
+                                ++s.admitting;
+                                return s.admission.pop_front()->handle;
+                            } else if (s.empty() and s.idle) {
+                                return std::exchange(s.idle, {});
+                            } else {
+                                return std::noop_coroutine();
+                            }
+                        }
+                        void await_resume() const noexcept {}
+                    };
+                    return awaitable{};
+                }
+                void return_void() const noexcept {}
+                void unhandled_exception() const noexcept { std::terminate(); }
+            };
+            std::coroutine_handle<promise_type> coro;
+        };
+        static runner run(reclaiming_starter &s, task_type t) {
+            try {
+                co_await std::move(t);
+            } catch (...) { s.failed(std::current_exception()); }
+        }
+        bool has_room() const noexcept {
+            return live + admitting < limit and admission.empty();
+        }
+        void failed(std::exception_ptr e) {
+            if (sink) {
+                sink(std::move(e));
+            } else {
+                errors.push_back(std::move(e));
+            }
+        }
+
+        waiter_list running;
+        std::size_t live = {};
+        std::size_t limit = std::numeric_limits<std::size_t>::max();
+        /// Coroutines waiting in `spawn`, and the number that have been
+        /// continued but haven't yet started their task
+        waiter_list admission;
+        std::size_t admitting = {};
+        std::coroutine_handle<> idle = {};
+        error_sink_type sink;
+        std::vector<std::exception_ptr> errors;
+    };
+
+
+}
@@ -0,0 +1,285 @@
+#pragma once
+
+
+#include <felspar/coro/coroutine.hpp>
+#include <felspar/coro/executor.hpp>
+#include <felspar/coro/waiter_list.hpp>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+
+namespace felspar::coro {
+
+
+    /// ## What a `ring_bus` does when a subscriber falls behind
+    enum class ring_bus_overflow {
+        /// Publishers wait until the slowest subscriber has read the oldest
+        /// value
+        block,
+        /// The oldest value is overwritten, and subscribers that hadn't read
+        /// it skip ahead and count what they missed
+        lap
+    };
+
+
+    /// ## A data distribution bus that doesn't lose values
+    /**
+     * Values are published into a ring of `N` slots allocated along with the
+     * bus. Each subscriber has its own cursor into the ring, so every value
+     * published after it subscribed is delivered to it whether or not it was
+     * waiting at the time, and it is given a reference to the value in the
+     * ring rather than a copy. The reference is valid until the subscriber
+     * asks for the next value (or, with `ring_bus_overflow::lap`, until the
+     * slot is overwritten).
+     *
+     * Publishing costs the same however many subscribers there are, apart
+     * from continuing those that are waiting for a value. Like the `bus` there
+     * is no thread synchronisation, and waiting coroutines are resumed from
+     * inside the call that makes them runnable unless an
+     * [executor](./executor.hpp) is given.
+     */
+    template<
+            typename T,
+            std::size_t N,
+            ring_bus_overflow Overflow = ring_bus_overflow::block>
+    class ring_bus final {
+        static_assert(N > 0, "The ring must have at least one slot");
+
+        struct slot {
+            std::optional<T> value;
+            /// The number of subscribers yet to finish with the value
+            std::size_t pending = {};
+        };
+        std::array<slot, N> ring = {};
+        /// The sequence number of the next value to be published
+        std::uint64_t published = {};
+        std::size_t subscribers = {};
+        struct writer : public waiter_node {
+            T *value;
+        };
+        waiter_list readers, writers;
+        executor *exec = nullptr;
+
+        slot &at(std::uint64_t const seq) noexcept { return ring[seq % N]; }
+
+        bool can_write() noexcept {
+            return writers.empty() and at(published).pending == 0;
+        }
+        void write(T t) {
+            auto &s = at(published);
+            s.value = std::move(t);
+            if constexpr (Overflow == ring_bus_overflow::block) {
+                s.pending = subscribers;
+            }
+            ++published;
+            readers.drain(
+                    [this](waiter_node &n) { resume_on(exec, n.handle); });
+        }
+        /// A subscriber has finished with the value. Waiting publishers
+        /// have their values written before they are continued
+        void release(std::uint64_t const seq) {
+            if (--at(seq).pending == 0) {
+                while (not writers.empty() and at(published).pending == 0) {
+                    auto *const w = static_cast<writer *>(writers.pop_front());
+                    write(std::move(*w->value));
+                    resume_on(exec, w->handle);
+                }
+            }
+        }
+
+
+      public:
+        using value_type = T;
+        static constexpr std::size_t capacity = N;
+        static constexpr ring_bus_overflow overflow = Overflow;
+
+
+        ring_bus() = default;
+        explicit ring_bus(executor &e) : exec{&e} {}
+        ring_bus(ring_bus const &) = delete;
+        ring_bus(ring_bus &&) = delete;
+
+        ring_bus &operator=(ring_bus const &) = delete;
+        ring_bus &operator=(ring_bus &&) = delete;
+
+
+        /// ### A subscriber's view of the bus
+        class subscriber final {
+            friend class ring_bus;
+            ring_bus *b;
+            /// The sequence number of the next value to read
+            std::uint64_t cursor;
+            /// True whilst the value before the cursor is still in use
+            bool holding = false;
+            std::uint64_t skipped = {};
+
+            subscriber(ring_bus &rb)
+            : b{&rb}, cursor{rb.published} {
+                ++b->subscribers;
+            }
+
+            void done_with_held() {
+                if constexpr (Overflow == ring_bus_overflow::block) {
+                    if (holding) { b->release(cursor - 1); }
+                }
+                holding = false;
+            }
+            bool available() const noexcept { return cursor < b->published; }
+            T const &read() {
+                if constexpr (Overflow == ring_bus_overflow::lap) {
+                    if (b->published - cursor > N) {
+                        skipped += b->published - N - cursor;
+                        cursor = b->published - N;
+                    }
+                }
+                holding = true;
+                return *b->at(cursor++).value;
+            }
+
+          public:
+            subscriber(subscriber const &) = delete;
+            /// Must not be moved whilst waiting for a value
+            subscriber(subscriber &&o) noexcept
+            : b{std::exchange(o.b, nullptr)},
+              cursor{o.cursor},
+              holding{o.holding},
+              skipped{o.skipped} {}
+            ~subscriber() {
+                if (not b) { return; }
+                /// Values published whilst releasing are written without
+                /// counting this subscriber, so only those published before
+                /// now are released
+                --b->subscribers;
+                auto const end = b->published;
+                done_with_held();
+                if constexpr (Overflow == ring_bus_overflow::block) {
+                    for (auto seq = cursor; seq < end; ++seq) {
+                        b->release(seq);
+                    }
+                }
+            }
+
+            subscriber &operator=(subscriber const &) = delete;
+            subscriber &operator=(subscriber &&) = delete;
+
+
+            /// #### The number of values published but not yet read
+            /// Can be more than the ring holds if the subscriber was lapped
+            [[nodiscard]] std::uint64_t backlog() const noexcept {
+                return b->published - cursor;
+            }
+            /// #### The number of values skipped because of being lapped
+            [[nodiscard]] std::uint64_t missed() const noexcept {
+                return skipped;
+            }
+
+
+            /// #### Read the next value without waiting
+            /// Returns `nullptr` if no value has been published since the
+            /// last one read
+            T const *try_next() {
+                done_with_held();
+                return available() ? &read() : nullptr;
+            }
+
+
+            /// #### Wait for the next value
+            FELSPAR_CORO_WRAPPER auto next() {
+                struct FELSPAR_CORO_CRT awaitable {
+                    subscriber &s;
+                    waiter_node node = {};
+
+                    awaitable(subscriber &ss) : s{ss} {}
+                    awaitable(awaitable const &) = delete;
+                    awaitable(awaitable &&) = delete;
+                    ~awaitable() { s.b->readers.remove(node); }
+
+                    awaitable &operator=(awaitable const &) = delete;
+                    awaitable &operator=(awaitable &&) = delete;
+
+                    bool await_ready() {
+                        s.done_with_held();
+                        return s.available();
+                    }
+                    void await_suspend(std::coroutine_handle<> h) noexcept {
+                        node.handle = h;
+                        s.b->readers.push_back(node);
+                    }
+                    T const &await_resume() { return s.read(); }
+                };
+                return awaitable{*this};
+            }
+        };
+
+
+        /// ### Subscribe to the values published from now on
+        [[nodiscard]] subscriber subscribe() { return subscriber{*this}; }
+
+
+        /// ### Query the bus
+        [[nodiscard]] std::size_t subscriber_count() const noexcept {
+            return subscribers;
+        }
+        /// #### The sequence number the next value will be published with
+        [[nodiscard]] std::uint64_t sequence() const noexcept {
+            return published;
+        }
+
+
+        /// ### Publish a value
+
+        /// #### Publish without waiting
+        /// Returns false, and doesn't publish, if the ring is full
+        [[nodiscard]] bool try_push(T t) {
+            if (can_write()) {
+                write(std::move(t));
+                return true;
+            } else {
+                return false;
+            }
+        }
+
+        /// #### Always publish, overwriting the oldest value
+        void push(T t) requires(Overflow == ring_bus_overflow::lap) {
+            write(std::move(t));
+        }
+
+        /// #### Publish once there is room in the ring
+        /// Waiting publishers publish in the order they started waiting
+        FELSPAR_CORO_WRAPPER auto publish(T t) {
+            struct FELSPAR_CORO_CRT awaitable {
+                ring_bus &b;
+                T value;
+                writer node = {};
+
+                awaitable(ring_bus &rb, T v) : b{rb}, value{std::move(v)} {}
+                awaitable(awaitable const &) = delete;
+                awaitable(awaitable &&) = delete;
+                ~awaitable() { b.writers.remove(node); }
+
+                awaitable &operator=(awaitable const &) = delete;
+                awaitable &operator=(awaitable &&) = delete;
+
+                bool await_ready() {
+                    if (b.can_write()) {
+                        b.write(std::move(value));
+                        return true;
+                    } else {
+                        return false;
+                    }
+                }
+                void await_suspend(std::coroutine_handle<> h) noexcept {
+                    node.handle = h;
+                    node.value = &value;
+                    b.writers.push_back(node);
+                }
+                void await_resume() const noexcept {}
+            };
+            return awaitable{*this, std::move(t)};
+        }
+    };
+
+
+}
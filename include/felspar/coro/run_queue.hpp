@@ -0,0 +1,101 @@
+#pragma once
+
+
+#include <felspar/coro/executor.hpp>
+
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+
+namespace felspar::coro {
+
+
+    /// ## A single threaded run queue
+    /**
+     * Continuations posted to the queue are run in FIFO order from `run` or
+     * `run_one`, which must only be called from the thread that created the
+     * queue. Posting from that thread needs no synchronisation. Continuations
+     * posted from other threads go into a separate mutex protected inbox that
+     * is moved into the queue whenever it runs out of local work.
+     *
+     * The queue holds only the coroutine handles, it doesn't own them. Any
+     * coroutine that has been posted must not be destroyed before the queue
+     * has run it.
+     */
+    class run_queue final : public executor {
+        std::thread::id const owner = std::this_thread::get_id();
+        std::deque<std::coroutine_handle<>> ready;
+
+        std::mutex mtx;
+        std::deque<std::coroutine_handle<>> remote;
+        std::atomic<std::size_t> remote_size{};
+
+        void take_remote() {
+            if (remote_size.load(std::memory_order_acquire)) {
+                std::scoped_lock lock{mtx};
+                ready.insert(ready.end(), remote.begin(), remote.end());
+                remote.clear();
+                remote_size.store(0, std::memory_order_relaxed);
+            }
+        }
+
+      public:
+        run_queue() = default;
+
+
+        /// ### Schedule a continuation
+        void post(std::coroutine_handle<> h) override {
+            if (std::this_thread::get_id() == owner) {
+                ready.push_back(h);
+            } else {
+                std::scoped_lock lock{mtx};
+                remote.push_back(h);
+                remote_size.fetch_add(1, std::memory_order_release);
+            }
+        }
+
+
+        /// ### Query the queue
+        /// Only meaningful when called from the thread that owns the queue
+        [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+        [[nodiscard]] std::size_t size() const noexcept {
+            return ready.size() + remote_size.load(std::memory_order_acquire);
+        }
+
+
+        /// ### Run a single continuation
+        /// Returns false if there was nothing to run
+        bool run_one() {
+            if (ready.empty()) { take_remote(); }
+            if (ready.empty()) {
+                return false;
+            } else {
+                auto h = ready.front();
+                ready.pop_front();
+                running const scope{*this};
+                h.resume();
+                return true;
+            }
+        }
+
+
+        /// ### Run continuations
+        /**
+         * Runs until the queue is empty, or until `limit` continuations have
+         * been run. Continuations posted while running are also run. Returns
+         * the number of continuations that were run.
+         */
+        std::size_t
+                run(std::size_t const limit =
+                            std::numeric_limits<std::size_t>::max()) {
+            std::size_t count{};
+            while (count < limit and run_one()) { ++count; }
+            return count;
+        }
+    };
+
+
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+
+#include <felspar/coro/allocator.hpp>
+#include <felspar/coro/coroutine.hpp>
+#include <felspar/coro/waiter_list.hpp>
+#include <felspar/exceptions.hpp>
+
+#include <exception>
+#include <optional>
+
+
+namespace felspar::coro {
+
+
+    template<typename T, typename Allocator = void>
+    class shared_task;
+
+
+    /// ## The result of a shared task
+    /**
+     * Stored in the promise, and read by every coroutine that awaits the
+     * task.
+     */
+    template<typename T>
+    struct shared_task_result {
+        using reference = T const &;
+
+        std::optional<T> value = {};
+        std::exception_ptr eptr = {};
+
+        void return_value(T t) { value = std::move(t); }
+        void unhandled_exception() noexcept { eptr = std::current_exception(); }
+
+        T const &result() const {
+            if (eptr) { std::rethrow_exception(eptr); }
+            return *value;
+        }
+    };
+    template<>
+    struct shared_task_result<void> {
+        using reference = void;
+
+        std::exception_ptr eptr = {};
+
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { eptr = std::current_exception(); }
+
+        void result() const {
+            if (eptr) { std::rethrow_exception(eptr); }
+        }
+    };
+
+
+    template<typename T, typename Allocator>
+    struct shared_task_promise :
+    public promise_allocator_impl<Allocator>,
+            public shared_task_result<T> {
+        using allocator_impl = promise_allocator_impl<Allocator>;
+        using allocator_impl::operator new;
+        using allocator_impl::operator delete;
+
+        /// The number of `shared_task` instances (including those held by
+        /// awaitables) referring to the coroutine
+        std::size_t references = 1;
+        bool started = false, completed = false;
+        waiter_list waiting;
+
+        shared_task<T, Allocator> get_return_object();
+
+        auto initial_suspend() noexcept {
+            return on_resume<allocator_impl>(*this, std::suspend_always{});
+        }
+        auto final_suspend() noexcept {
+            on_final<allocator_impl>(*this);
+            /// A continued coroutine may drop the last reference, so one is
+            /// held whilst they are being continued
+            struct awaitable {
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<shared_task_promise>
+                                           h) const noexcept {
+                    auto &p = h.promise();
+                    p.completed = true;
+                    ++p.references;
+                    p.waiting.drain([](waiter_node &n) { n.handle.resume(); });
+                    if (--p.references == 0) { h.destroy(); }
+                }
+                void await_resume() const noexcept {}
+            };
+            return awaitable{};
+        }
+    };
+
+
+    /// ## Tasks that can be awaited many times
+    /**
+     * A coroutine that is started the first time it is awaited, and whose
+     * result is then given to every coroutine that awaits it, as a `const`
+     * reference into the coroutine frame rather than a copy. Any number of
+     * coroutines may be waiting on it at once. Copies of a `shared_task`
+     * refer to the same coroutine, and the frame is destroyed along with the
+     * last copy.
+     *
+     * There is no thread synchronisation, and waiting coroutines are resumed
+     * by whichever thread completes the task. See
+     * [`atomic_shared_task`](./atomic_shared_task.hpp) for a thread safe
+     * version.
+     */
+    template<typename T, typename Allocator>
+    class [[nodiscard]] FELSPAR_CORO_CRT shared_task final {
+        friend struct shared_task_promise<T, Allocator>;
+
+
+      public:
+        using value_type = T;
+        using allocator_type = Allocator;
+        using promise_type = shared_task_promise<value_type, allocator_type>;
+        using handle_type = std::coroutine_handle<promise_type>;
+        using reference = typename shared_task_result<T>::reference;
+
+
+        /// ### Construction
+        shared_task(shared_task const &t) noexcept : coro{t.coro} {
+            if (coro) { ++coro.promise().references; }
+        }
+        shared_task(shared_task &&t) noexcept
+        : coro{std::exchange(t.coro, {})} {}
+        ~shared_task() { drop(); }
+
+        shared_task &operator=(shared_task const &t) noexcept {
+            shared_task c{t};
+            std::swap(coro, c.coro);
+            return *this;
+        }
+        shared_task &operator=(shared_task &&t) noexcept {
+            drop();
+            coro = std::exchange(t.coro, {});
+            return *this;
+        }
+
+
+        /// ### Query the task
+        [[nodiscard]] bool done() const noexcept {
+            return coro.promise().completed;
+        }
+
+
+        /// ### Awaitable
+        FELSPAR_CORO_WRAPPER auto operator co_await() const {
+            struct FELSPAR_CORO_CRT awaitable {
+                shared_task t;
+                waiter_node node = {};
+
+                awaitable(shared_task const &st) : t{st} {}
+                awaitable(awaitable const &) = delete;
+                awaitable(awaitable &&) = delete;
+                ~awaitable() { t.coro.promise().waiting.remove(node); }
+
+                awaitable &operator=(awaitable const &) = delete;
+                awaitable &operator=(awaitable &&) = delete;
+
+                bool await_ready() const noexcept { return t.done(); }
+                std::coroutine_handle<>
+                        await_suspend(std::coroutine_handle<> h) noexcept {
+                    auto &p = t.coro.promise();
+                    node.handle = h;
+                    p.waiting.push_back(node);
+                    if (not p.started) {
+                        p.started = true;
+                        return t.coro;
+                    } else {
+                        return std::noop_coroutine();
+                    }
+                }
+                reference await_resume() const {
+                    return t.coro.promise().result();
+                }
+            };
+            return awaitable{*this};
+        }
+
+
+        /// ### Or use this from a normal function
+        /**
+         * Starts the coroutine if it hasn't been, and throws if it can't then
+         * complete without waiting for something.
+         */
+        reference
+                get(std::source_location const &loc =
+                            std::source_location::current()) const {
+            auto &p = coro.promise();
+            if (not p.started) {
+                p.started = true;
+                coro.resume();
+            }
+            if (not p.completed) {
+                throw stdexcept::runtime_error{
+                        "The shared_task hasn't completed", loc};
+            }
+            return p.result();
+        }
+
+
+      private:
+        handle_type coro;
+
+        explicit shared_task(handle_type h) : coro{h} {}
+
+        void drop() noexcept {
+            if (coro and --coro.promise().references == 0) { coro.destroy(); }
+            coro = {};
+        }
+    };
+
+
+    template<typename T, typename Allocator>
+    inline auto shared_task_promise<T, Allocator>::get_return_object()
+            -> shared_task<T, Allocator> {
+        return shared_task<T, Allocator>{
+                std::coroutine_handle<shared_task_promise>::from_promise(
+                        *this)};
+    }
+
+
+}
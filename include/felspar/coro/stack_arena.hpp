@@ -0,0 +1,150 @@
+#pragma once
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+
+namespace felspar::coro {
+
+
+    /// ## Stack allocator for nested coroutine frames
+    /**
+     * A stateless allocator, so usable as e.g. `task<int, stack_arena<>>`,
+     * that bump allocates frames from thread local segments of
+     * `SegmentSize` bytes. When a coroutine awaits a child the child's frame
+     * is always destroyed before its parent's, so frames are nearly always
+     * released in the reverse order they were allocated, and releasing the
+     * most recently allocated frame makes its space available again straight
+     * away. When a segment fills up a new one is started, and segments are
+     * dropped again as they empty, with one kept spare so that a call chain
+     * crossing a segment boundary doesn't allocate every time.
+     *
+     * Frames released out of order leave a hole that is only reclaimed once
+     * every frame in the segment has been released. Frames may be released on
+     * any thread, and a segment outlives its thread if it still holds live
+     * frames. Frames too large to fit in a segment go to the global
+     * `operator new`.
+     */
+    template<std::size_t SegmentSize = 64 * 1024>
+    class stack_arena final {
+        static_assert(
+                (SegmentSize & (SegmentSize - 1)) == 0,
+                "The segment size must be a power of two");
+
+        static constexpr std::size_t granularity = alignof(std::max_align_t);
+        static constexpr std::size_t rounded(std::size_t const bytes) noexcept {
+            return (bytes + granularity - 1) & ~(granularity - 1);
+        }
+
+        struct segment {
+            /// The number of live frames, plus one whilst the segment is part
+            /// of a thread's arena
+            std::atomic<std::size_t> live{1};
+            segment *previous = nullptr;
+            std::byte *top;
+
+            segment() : top{base()} {}
+
+            std::byte *base() noexcept {
+                return reinterpret_cast<std::byte *>(this) + header_size;
+            }
+            std::byte *end() noexcept {
+                return reinterpret_cast<std::byte *>(this) + SegmentSize;
+            }
+            /// Reuse the whole segment if every frame has been released
+            void reset_if_empty() noexcept {
+                if (live.load(std::memory_order_acquire) == 1) { top = base(); }
+            }
+            /// Drop the reference held by the arena or by a frame
+            void release() noexcept {
+                if (live.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    this->~segment();
+                    ::operator delete(this, std::align_val_t{SegmentSize});
+                }
+            }
+        };
+        static constexpr std::size_t header_size = rounded(sizeof(segment));
+        static_assert(header_size < SegmentSize, "The segment is too small");
+
+        static segment *segment_of(void *const ptr) noexcept {
+            return reinterpret_cast<segment *>(
+                    reinterpret_cast<std::uintptr_t>(ptr) & ~(SegmentSize - 1));
+        }
+
+        struct arena {
+            segment *current = nullptr, *spare = nullptr;
+
+            ~arena() {
+                while (current) {
+                    std::exchange(current, current->previous)->release();
+                }
+                if (spare) { spare->release(); }
+            }
+
+            void push() {
+                segment *s = std::exchange(spare, nullptr);
+                if (not s) {
+                    s = new (::operator new(
+                            SegmentSize, std::align_val_t{SegmentSize})) segment;
+                }
+                s->previous = current;
+                current = s;
+            }
+            /// Drop the current segment whilst it is empty
+            void pop() noexcept {
+                while (current->previous
+                       and current->live.load(std::memory_order_acquire) == 1) {
+                    auto const s = std::exchange(current, current->previous);
+                    s->top = s->base();
+                    if (spare) { spare->release(); }
+                    spare = s;
+                    current->reset_if_empty();
+                }
+            }
+        };
+        static arena &local() {
+            thread_local arena a;
+            return a;
+        }
+
+
+      public:
+        static constexpr std::size_t segment_size = SegmentSize;
+        static constexpr std::size_t max_frame = SegmentSize - header_size;
+
+
+        /// ### Allocation
+        void *allocate(std::size_t const bytes) {
+            auto const size = rounded(bytes);
+            if (size > max_frame) { return ::operator new(bytes); }
+            auto &a = local();
+            if (a.current) { a.current->reset_if_empty(); }
+            if (not a.current or a.current->end() - a.current->top
+                        < static_cast<std::ptrdiff_t>(size)) {
+                a.push();
+            }
+            a.current->live.fetch_add(1, std::memory_order_relaxed);
+            return std::exchange(a.current->top, a.current->top + size);
+        }
+        void deallocate(void *const ptr, std::size_t const bytes) {
+            auto const size = rounded(bytes);
+            if (size > max_frame) { return ::operator delete(ptr); }
+            auto const s = segment_of(ptr);
+            auto &a = local();
+            if (s == a.current) {
+                auto const frame = static_cast<std::byte *>(ptr);
+                if (frame + size == s->top) { s->top = frame; }
+                s->release();
+                a.pop();
+            } else {
+                s->release();
+            }
+        }
+    };
+
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 
+#include <felspar/coro/stream.hpp>
 #include <felspar/coro/task.hpp>
 #include <felspar/exceptions.hpp>
 
@@ -17,6 +18,7 @@ namespace felspar::coro {
     class starter {
       public:
         using task_type = Task;
+        using value_type = typename task_type::value_type;
         using promise_type = typename task_type::promise_type;
         using unique_handle_type = typename promise_type::unique_handle_type;
 
@@ -104,6 +106,38 @@ namespace felspar::coro {
         }
 
 
+        /// ### Wait for the first coroutine to complete
+        /**
+         * Removes whichever held coroutine completes first and returns its
+         * result, or re-throws its exception. Coroutines that have already
+         * completed are taken first. Only coroutines held when the wait
+         * starts are waited for, and as the coroutines are resumed from
+         * within one another this must not be used with coroutines that are
+         * resumed by other threads.
+         */
+        task<value_type> wait_for_any(
+                std::source_location loc = std::source_location::current()) {
+            if (live.empty()) {
+                throw stdexcept::logic_error{
+                        "Cannot call starter::wait_for_any() if there are no "
+                        "items",
+                        loc};
+            }
+            co_return co_await co_await any_completed{*this};
+        }
+
+
+        /// ### Results in the order the coroutines complete
+        /**
+         * Yields the result of each held coroutine as it completes, until
+         * there are none left. An exception ends the stream.
+         */
+        stream<value_type> as_completed() requires(not std::is_void_v<value_type>)
+        {
+            while (not live.empty()) { co_yield co_await wait_for_any(); }
+        }
+
+
         /// ### Delete all coroutines
         /**
          * Calling this from any of the running coroutines will invoke undefined
@@ -113,6 +147,29 @@ namespace felspar::coro {
 
       private:
         std::vector<unique_handle_type> live;
+
+        /// Continues the waiting coroutine with the first completed task
+        struct any_completed {
+            starter &s;
+
+            bool await_ready() const noexcept {
+                return std::any_of(
+                        s.live.begin(), s.live.end(),
+                        [](auto const &h) { return h.promise().has_value(); });
+            }
+            void await_suspend(std::coroutine_handle<> h) noexcept {
+                for (auto &c : s.live) { c.promise().continuation = h; }
+            }
+            task_type await_resume() {
+                for (auto &c : s.live) { c.promise().continuation = {}; }
+                auto const pos = std::find_if(
+                        s.live.begin(), s.live.end(),
+                        [](auto const &h) { return h.promise().has_value(); });
+                task_type t{std::move(*pos)};
+                s.live.erase(pos);
+                return t;
+            }
+        };
     };
 
 
@@ -2,7 +2,10 @@
 
 
 #include <felspar/coro/allocator.hpp>
+#include <felspar/coro/batch.hpp>
 #include <felspar/coro/coroutine.hpp>
+#include <felspar/coro/elements_of.hpp>
+#include <felspar/exceptions.hpp>
 #include <felspar/memory/holding_pen.hpp>
 
 #include <exception>
@@ -15,11 +18,15 @@ namespace felspar::coro {
     class stream_awaitable;
     template<typename Y, typename Allocator>
     struct stream_promise;
+    template<typename Y, typename Allocator, typename... Stages>
+    class fused_stream;
 
 
     template<typename Y, typename Allocator = void>
     class FELSPAR_CORO_CRT stream final {
         friend struct stream_promise<Y, Allocator>;
+        template<typename, typename, typename...>
+        friend class fused_stream;
         using handle_type = typename stream_promise<Y, Allocator>::handle_type;
         handle_type yielding_coro;
 
@@ -39,13 +46,64 @@ namespace felspar::coro {
         ~stream() = default;
 
         FELSPAR_CORO_WRAPPER stream_awaitable<Y, handle_type> next();
+
+        /// ### Fetch many values at once
+        /**
+         * Values are moved into the buffer as they are yielded, and the
+         * awaiting coroutine is only continued once it is full or the stream
+         * has completed. The awaitable returns the number of values in the
+         * buffer, so a return value of less than the buffer size means the
+         * stream has completed. If the stream throws, the exception is
+         * re-thrown and any values already in the buffer are lost.
+         */
+        FELSPAR_CORO_WRAPPER auto next_batch(
+                std::span<Y> buffer,
+                std::source_location const &loc =
+                        std::source_location::current()) {
+            static_assert(
+                    batch_buffer<Y>::batchable,
+                    "next_batch needs a move assignable value type");
+            if (buffer.empty()) {
+                throw stdexcept::logic_error{
+                        "The buffer for next_batch must not be empty", loc};
+            }
+            struct FELSPAR_CORO_CRT awaitable {
+                handle_type &coro;
+                std::span<Y> buffer;
+                ~awaitable() {
+                    coro.promise().continuation = {};
+                    coro.promise().end_batch();
+                }
+
+                bool await_ready() noexcept {
+                    if (coro.promise().completed) { return true; }
+                    coro.promise().start_batch(buffer);
+                    return coro.promise().full();
+                }
+                auto await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                    coro.promise().continuation = awaiting;
+                    return coro.promise().resume_point();
+                }
+                std::size_t await_resume() {
+                    auto const count = coro.promise().end_batch();
+                    if (auto eptr = coro.promise().eptr) {
+                        std::rethrow_exception(eptr);
+                    }
+                    return count;
+                }
+            };
+            return awaitable{yielding_coro, buffer};
+        }
     };
 
 
     template<typename Y, typename Allocator>
-    struct stream_promise : private promise_allocator_impl<Allocator> {
-        using promise_allocator_impl<Allocator>::operator new;
-        using promise_allocator_impl<Allocator>::operator delete;
+    struct stream_promise :
+    public promise_allocator_impl<Allocator>,
+            public batch_buffer<Y> {
+        using allocator_impl = promise_allocator_impl<Allocator>;
+        using allocator_impl::operator new;
+        using allocator_impl::operator delete;
 
         std::coroutine_handle<> continuation = {};
         bool completed = false;
@@ -54,9 +112,109 @@ namespace felspar::coro {
 
         using handle_type = unique_handle<stream_promise>;
 
+        /// Whilst delegating to another stream with `elements_of`, the
+        /// outermost promise is the `root` and it holds the `innermost`
+        /// coroutine which is the one that is to be resumed
+        stream_promise *root = this, *parent = nullptr;
+        std::coroutine_handle<> innermost = {};
+
+        std::coroutine_handle<> resume_point() {
+            if (innermost) {
+                return innermost;
+            } else {
+                return std::coroutine_handle<stream_promise>::from_promise(
+                        *this);
+            }
+        }
+
         auto yield_value(Y y) {
-            value.assign(std::move(y));
-            return symmetric_continuation{std::exchange(continuation, {})};
+            return on_resume<allocator_impl>(*this, deliver_value(std::move(y)));
+        }
+        auto yield_value(std::span<Y> ys) {
+            return on_resume<allocator_impl>(*this, deliver_values(ys));
+        }
+        /// Values are always delivered by the root stream's promise
+        conditional_continuation deliver_value(Y y) {
+            if (root != this) {
+                return root->deliver_value(std::move(y));
+            } else if (this->sink) {
+                return pause(this->sink->push(std::move(y)));
+            } else if (this->batching()) {
+                this->add(std::move(y));
+                return deliver();
+            } else {
+                value.assign(std::move(y));
+                return conditional_continuation{
+                        std::exchange(continuation, {}), true};
+            }
+        }
+        conditional_continuation deliver_values(std::span<Y> ys) {
+            if (root != this) { return root->deliver_values(ys); }
+            this->pending = ys;
+            if (this->sink) {
+                return pause(this->feed_pending());
+            } else if (this->batching()) {
+                this->drain();
+                return deliver();
+            } else if (take_pending()) {
+                return conditional_continuation{
+                        std::exchange(continuation, {}), true};
+            } else {
+                return conditional_continuation{{}, false};
+            }
+        }
+        /// Delegate to another stream
+        template<typename S>
+        requires std::same_as<std::remove_cvref_t<S>, stream<Y, Allocator>>
+        auto yield_value(elements_of<S> e) {
+            struct awaitable {
+                stream_promise &outer;
+                handle_type &inner;
+
+                bool await_ready() const noexcept {
+                    return inner.promise().completed;
+                }
+                std::coroutine_handle<>
+                        await_suspend(std::coroutine_handle<>) noexcept {
+                    inner.promise().root = outer.root;
+                    inner.promise().parent = &outer;
+                    outer.root->innermost = inner.get();
+                    return inner.get();
+                }
+                void await_resume() {
+                    if (auto eptr = inner.promise().eptr) {
+                        std::rethrow_exception(eptr);
+                    }
+                }
+            };
+            return on_resume<allocator_impl>(
+                    *this, awaitable{*this, e.range.yielding_coro});
+        }
+        /// Move the next of any pending values into `value`
+        bool take_pending() {
+            if (this->pending.empty()) {
+                return false;
+            } else {
+                value.assign(std::move(this->pending.front()));
+                this->pending = this->pending.subspan(1);
+                return true;
+            }
+        }
+        /// Only continue the consumer once its batch is full
+        conditional_continuation deliver() {
+            if (this->full()) {
+                return {std::exchange(continuation, {}), true};
+            } else {
+                return {{}, false};
+            }
+        }
+        /// Only continue the consumer once the sink asks for it
+        conditional_continuation pause(sink_status const status) {
+            if (status.suspend()) {
+                return {std::exchange(continuation, {}), true};
+            } else {
+                return {{}, false};
+            }
         }
 
         void unhandled_exception() {
@@ -73,9 +231,21 @@ namespace felspar::coro {
             return stream<Y, Allocator>{handle_type::from_promise(*this)};
         }
 
-        auto initial_suspend() const noexcept { return std::suspend_always{}; }
-        auto final_suspend() const noexcept {
-            return symmetric_continuation{continuation};
+        auto initial_suspend() noexcept {
+            return on_resume<allocator_impl>(*this, std::suspend_always{});
+        }
+        /// A delegated stream returns to its parent
+        auto final_suspend() noexcept {
+            on_final<allocator_impl>(*this);
+            if (parent) {
+                auto const h =
+                        std::coroutine_handle<stream_promise>::from_promise(
+                                *parent);
+                root->innermost = parent == root ? nullptr : h;
+                return symmetric_continuation{h};
+            } else {
+                return symmetric_continuation{continuation};
+            }
         }
     };
 
@@ -87,19 +257,26 @@ namespace felspar::coro {
 
       public:
         stream_awaitable(H &c) : continuation{c} {}
-        ~stream_awaitable() { continuation.promise().continuation = {}; }
+        /// The stream may have been destroyed by a `cancellable`
+        ~stream_awaitable() {
+            if (continuation) { continuation.promise().continuation = {}; }
+        }
 
         bool await_ready() const noexcept {
-            return continuation.promise().completed;
+            return continuation.promise().completed
+                    or not continuation.promise().pending.empty();
         }
         auto await_suspend(std::coroutine_handle<> awaiting) noexcept {
             continuation.promise().continuation = awaiting;
-            return continuation.get();
+            return continuation.promise().resume_point();
         }
         memory::holding_pen<Y> await_resume() {
             if (auto eptr = continuation.promise().eptr) {
                 std::rethrow_exception(eptr);
             } else {
+                if (not continuation.promise().value) {
+                    continuation.promise().take_pending();
+                }
                 return std::move(continuation.promise().value).transfer_out();
             }
         }
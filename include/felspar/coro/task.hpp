@@ -6,6 +6,7 @@
 #include <felspar/coro/forward.hpp>
 #include <felspar/exceptions.hpp>
 
+#include <atomic>
 #include <exception>
 #include <optional>
 #include <stdexcept>
@@ -14,10 +15,92 @@
 namespace felspar::coro {
 
 
+    /// ## Shared completion state for a group of tasks
+    /**
+     * Used by [`when_all`](./when_all.hpp) and [`when_any`](./when_any.hpp) to
+     * wait on several tasks at once. Every task in the group counts down the
+     * same counter as it completes, and the coroutine waiting on the group is
+     * continued by whichever task takes it to zero. The counter starts with
+     * one extra count for the waiting coroutine itself, which it removes once
+     * all of the tasks have been started, so that tasks that complete without
+     * suspending can't continue it before it has suspended.
+     *
+     * A group whose waiting coroutine is to be continued by the first task
+     * to complete (as `when_any`'s is) is created by `make_shared`. Only the
+     * first completion counts, and it is recorded as the `winner`. Tasks that
+     * are still running when the awaitable lets go of them are then left to
+     * complete, and destroy themselves when they do. The group is freed once
+     * the awaitable and every task that joined it are done with it.
+     */
+    struct task_group {
+        std::atomic<std::size_t> remaining = {};
+        std::coroutine_handle<> continuation = {};
+        bool shared = false;
+        std::atomic<std::size_t> holders = {};
+        std::atomic<void *> winner = {};
+
+        static task_group *make_shared() {
+            auto *const g = new task_group;
+            g->shared = true;
+            g->holders.store(1, std::memory_order_relaxed);
+            return g;
+        }
+        /// Called once by each holder of a shared group
+        void release() noexcept {
+            if (holders.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                delete this;
+            }
+        }
+
+        /// Returns the continuation if this was the last count. `by` is the
+        /// address of the completing task's frame
+        std::coroutine_handle<> completed(void *const by) noexcept {
+            void *first = nullptr;
+            if (shared
+                and not winner.compare_exchange_strong(
+                        first, by, std::memory_order_acq_rel)) {
+                return {};
+            } else if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                return continuation;
+            } else {
+                return {};
+            }
+        }
+
+        /// Start a task (given as its handle) as part of the group
+        template<typename H>
+        void join(H &h) {
+            auto &p = h.promise();
+            if (p.has_value()) {
+                completed(h.get().address());
+            } else {
+                p.group = this;
+                if (shared) { holders.fetch_add(1, std::memory_order_relaxed); }
+                if (not p.started) {
+                    p.started = true;
+                    h.resume();
+                }
+            }
+        }
+
+        /// Let go of a task in a shared group. A task that has yet to
+        /// complete is released from `h` and destroys itself
+        template<typename H>
+        void let_go(H &h) noexcept {
+            if (h and h.promise().group == this
+                and not h.promise().released.exchange(
+                        true, std::memory_order_acq_rel)) {
+                h.release();
+            }
+        }
+    };
+
+
     template<typename Allocator>
-    struct task_promise_base : private promise_allocator_impl<Allocator> {
-        using promise_allocator_impl<Allocator>::operator new;
-        using promise_allocator_impl<Allocator>::operator delete;
+    struct task_promise_base : public promise_allocator_impl<Allocator> {
+        using allocator_impl = promise_allocator_impl<Allocator>;
+        using allocator_impl::operator new;
+        using allocator_impl::operator delete;
 
         /// Flag to ensure the coroutine is started at appropriate points in time
         bool started = false;
@@ -28,11 +111,55 @@ namespace felspar::coro {
         }
         /// The continuation that is to run when the task is complete
         std::coroutine_handle<> continuation = {};
-
-        auto initial_suspend() const noexcept { return std::suspend_always{}; }
+        /// Or the group the task is being waited on as a part of
+        task_group *group = nullptr;
+        /// In a shared group, exchanged by both the task completing and the
+        /// group letting go of it, so that the second destroys the frame
+        std::atomic<bool> released = false;
+
+        auto initial_suspend() noexcept {
+            return on_resume<allocator_impl>(*this, std::suspend_always{});
+        }
         void unhandled_exception() noexcept { eptr = std::current_exception(); }
         auto final_suspend() noexcept {
-            return symmetric_continuation{std::exchange(continuation, {})};
+            on_final<allocator_impl>(*this);
+            /**
+             * A group must only be counted down once this coroutine has
+             * suspended, as the last task to complete in a group may be on
+             * another thread and will destroy all of the others.
+             */
+            struct awaitable {
+                task_group *group;
+                std::coroutine_handle<> continuation;
+                std::atomic<bool> &released;
+
+                bool await_ready() const noexcept { return false; }
+                std::coroutine_handle<> await_suspend(
+                        std::coroutine_handle<> self) const noexcept {
+                    /// Unless it is shared, the group may be gone once it
+                    /// has been counted down
+                    auto *const g = group;
+                    bool const shared = g and g->shared;
+                    auto next =
+                            g ? g->completed(self.address()) : continuation;
+                    if (shared) {
+                        /// Once exchanged the frame, which holds this
+                        /// awaiter, may be destroyed by the group
+                        bool const last = released.exchange(
+                                true, std::memory_order_acq_rel);
+                        g->release();
+                        if (last) { self.destroy(); }
+                    }
+                    if (next) {
+                        return next;
+                    } else {
+                        return std::noop_coroutine();
+                    }
+                }
+                void await_resume() const noexcept {}
+            };
+            return awaitable{
+                    group, std::exchange(continuation, {}), released};
         }
     };
     template<typename Allocator>
@@ -0,0 +1,354 @@
+#pragma once
+
+
+#include <felspar/coro/executor.hpp>
+#include <felspar/coro/task.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+namespace felspar::coro {
+
+
+    /// ## Work stealing deque
+    /**
+     * The Chase-Lev deque as described in "Correct and Efficient Work-Stealing
+     * for Weak Memory Models" (Lê, Pop, Cohen & Nardelli). Only the owning
+     * thread may `push` and `pop`, any thread may `steal`.
+     *
+     * Arrays that are replaced when the deque grows are retired rather than
+     * freed, as a thief may still be reading from them. They are released when
+     * the deque is destroyed.
+     */
+    class work_stealing_deque final {
+        struct array {
+            explicit array(std::int64_t const c)
+            : capacity{c}, slots{std::make_unique<std::atomic<void *>[]>(
+                                   static_cast<std::size_t>(c))} {}
+
+            std::int64_t const capacity;
+            std::unique_ptr<std::atomic<void *>[]> slots;
+
+            void *get(std::int64_t const i) const noexcept {
+                return slots[static_cast<std::size_t>(i & (capacity - 1))].load(
+                        std::memory_order_relaxed);
+            }
+            void put(std::int64_t const i, void *const p) noexcept {
+                slots[static_cast<std::size_t>(i & (capacity - 1))].store(
+                        p, std::memory_order_relaxed);
+            }
+        };
+
+        std::atomic<std::int64_t> top{0}, bottom{0};
+        std::atomic<array *> current;
+        std::vector<std::unique_ptr<array>> arrays;
+
+        array *grow(array *const a, std::int64_t const b, std::int64_t const t) {
+            auto &bigger =
+                    arrays.emplace_back(std::make_unique<array>(a->capacity * 2));
+            for (auto i = t; i != b; ++i) { bigger->put(i, a->get(i)); }
+            current.store(bigger.get(), std::memory_order_release);
+            return bigger.get();
+        }
+
+      public:
+        explicit work_stealing_deque(std::int64_t const capacity = 256) {
+            current.store(
+                    arrays.emplace_back(std::make_unique<array>(capacity)).get(),
+                    std::memory_order_relaxed);
+        }
+        work_stealing_deque(work_stealing_deque const &) = delete;
+        work_stealing_deque &operator=(work_stealing_deque const &) = delete;
+
+
+        /// ### Owner interface
+        void push(std::coroutine_handle<> const h) {
+            auto const b = bottom.load(std::memory_order_relaxed);
+            auto const t = top.load(std::memory_order_acquire);
+            auto *a = current.load(std::memory_order_relaxed);
+            if (b - t > a->capacity - 1) { a = grow(a, b, t); }
+            a->put(b, h.address());
+            bottom.store(b + 1, std::memory_order_release);
+        }
+        std::coroutine_handle<> pop() noexcept {
+            auto const b = bottom.load(std::memory_order_relaxed) - 1;
+            auto *const a = current.load(std::memory_order_relaxed);
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto t = top.load(std::memory_order_relaxed);
+            void *p = nullptr;
+            if (t <= b) {
+                p = a->get(b);
+                if (t == b) {
+                    if (not top.compare_exchange_strong(
+                                t, t + 1, std::memory_order_seq_cst,
+                                std::memory_order_relaxed)) {
+                        p = nullptr;
+                    }
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                }
+            } else {
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return std::coroutine_handle<>::from_address(p);
+        }
+
+
+        /// ### Thief interface
+        std::coroutine_handle<> steal() noexcept {
+            auto t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto const b = bottom.load(std::memory_order_acquire);
+            if (t < b) {
+                void *const p =
+                        current.load(std::memory_order_acquire)->get(t);
+                if (top.compare_exchange_strong(
+                            t, t + 1, std::memory_order_seq_cst,
+                            std::memory_order_relaxed)) {
+                    return std::coroutine_handle<>::from_address(p);
+                }
+            }
+            return {};
+        }
+    };
+
+
+    /// ## Work stealing thread pool
+    /**
+     * Each worker thread has its own [work stealing
+     * deque](#work-stealing-deque). Continuations posted from a worker go onto
+     * that worker's deque, and those posted from any other thread go into a
+     * shared injection queue. Idle workers steal from randomly chosen other
+     * workers before going to sleep.
+     *
+     * The destructor waits for all queued continuations to be run before
+     * joining the worker threads.
+     */
+    class thread_pool final : public executor {
+        struct worker {
+            worker(thread_pool &p, std::size_t const i)
+            : pool{p}, random{static_cast<unsigned>(i + 1)} {}
+
+            thread_pool &pool;
+            std::minstd_rand random;
+            work_stealing_deque deque;
+            std::thread thread;
+        };
+        std::vector<std::unique_ptr<worker>> workers;
+
+        std::mutex mtx;
+        std::condition_variable wakeup, idle;
+        std::deque<std::coroutine_handle<>> injected;
+        std::atomic<std::size_t> injected_size{}, sleeping{};
+        bool stopping = false;
+
+        std::atomic<std::size_t> outstanding{};
+        std::exception_ptr first_error;
+
+
+        static worker *&this_worker() noexcept {
+            thread_local worker *w = nullptr;
+            return w;
+        }
+
+        std::coroutine_handle<> take_injected() {
+            if (injected.empty()) {
+                return {};
+            } else {
+                auto h = injected.front();
+                injected.pop_front();
+                injected_size.fetch_sub(1, std::memory_order_relaxed);
+                return h;
+            }
+        }
+        std::coroutine_handle<> steal(worker &w) {
+            auto const count = workers.size();
+            auto const start = w.random() % count;
+            for (std::size_t n{}; n < count; ++n) {
+                auto &victim = *workers[(start + n) % count];
+                if (&victim != &w) {
+                    if (auto h = victim.deque.steal(); h) { return h; }
+                }
+            }
+            return {};
+        }
+        std::coroutine_handle<> find_work(worker &w) {
+            if (auto h = w.deque.pop(); h) { return h; }
+            if (injected_size.load(std::memory_order_relaxed)) {
+                std::scoped_lock lock{mtx};
+                if (auto h = take_injected(); h) { return h; }
+            }
+            return steal(w);
+        }
+
+        void run(worker &w) {
+            this_worker() = &w;
+            running const scope{*this};
+            while (true) {
+                if (auto h = find_work(w); h) {
+                    h.resume();
+                    continue;
+                }
+                std::unique_lock lock{mtx};
+                sleeping.fetch_add(1, std::memory_order_seq_cst);
+                auto h = take_injected();
+                if (not h) { h = steal(w); }
+                if (h) {
+                    sleeping.fetch_sub(1, std::memory_order_relaxed);
+                    lock.unlock();
+                    h.resume();
+                } else if (stopping) {
+                    sleeping.fetch_sub(1, std::memory_order_relaxed);
+                    return;
+                } else {
+                    wakeup.wait(lock);
+                    sleeping.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+        }
+
+
+        /// ### Posted tasks
+        struct job {
+            struct promise_type {
+                thread_pool &pool;
+
+                template<typename... Args>
+                promise_type(thread_pool &p, Args &...) : pool{p} {}
+                ~promise_type() { pool.job_done(); }
+
+                job get_return_object() {
+                    return {std::coroutine_handle<promise_type>::from_promise(
+                            *this)};
+                }
+                auto initial_suspend() const noexcept {
+                    return std::suspend_always{};
+                }
+                void unhandled_exception() noexcept {
+                    pool.job_failed(std::current_exception());
+                }
+                void return_void() noexcept {}
+                auto final_suspend() const noexcept {
+                    return std::suspend_never{};
+                }
+            };
+            std::coroutine_handle<promise_type> coro;
+        };
+        template<typename T, typename A>
+        static job run_job(thread_pool &, task<T, A> t) {
+            co_await std::move(t);
+        }
+        void job_failed(std::exception_ptr e) {
+            std::scoped_lock lock{mtx};
+            if (not first_error) { first_error = std::move(e); }
+        }
+        void job_done() {
+            if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::scoped_lock lock{mtx};
+                idle.notify_all();
+            }
+        }
+
+
+      public:
+        /// ### Construction
+        explicit thread_pool(
+                std::size_t const threads = std::thread::hardware_concurrency()) {
+            for (std::size_t i{}; i < (threads ? threads : 1); ++i) {
+                workers.push_back(std::make_unique<worker>(*this, i));
+            }
+            for (auto &w : workers) {
+                w->thread = std::thread{[this, &w = *w]() { run(w); }};
+            }
+        }
+        ~thread_pool() {
+            {
+                std::scoped_lock lock{mtx};
+                stopping = true;
+                wakeup.notify_all();
+            }
+            for (auto &w : workers) { w->thread.join(); }
+        }
+
+
+        /// ### The number of worker threads
+        [[nodiscard]] std::size_t size() const noexcept {
+            return workers.size();
+        }
+
+
+        /// ### Schedule a continuation
+        void post(std::coroutine_handle<> h) override {
+            if (auto *w = this_worker(); w and &w->pool == this) {
+                w->deque.push(h);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (sleeping.load(std::memory_order_relaxed)) {
+                    std::scoped_lock lock{mtx};
+                    wakeup.notify_one();
+                }
+            } else {
+                std::scoped_lock lock{mtx};
+                injected.push_back(h);
+                injected_size.fetch_add(1, std::memory_order_relaxed);
+                if (sleeping.load(std::memory_order_relaxed)) {
+                    wakeup.notify_one();
+                }
+            }
+        }
+
+
+        /// ### Continue the awaiting coroutine on one of the pool's threads
+        FELSPAR_CORO_WRAPPER auto schedule() noexcept {
+            struct FELSPAR_CORO_CRT awaitable {
+                thread_pool &pool;
+
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<> h) {
+                    pool.post(h);
+                }
+                void await_resume() const noexcept {}
+            };
+            return awaitable{*this};
+        }
+
+
+        /// ### Run a task on the pool
+        /**
+         * The task is started on one of the worker threads and the pool
+         * takes over ownership of it. Any return value is discarded, and the
+         * first exception thrown by any posted task is re-thrown by `wait`.
+         */
+        template<typename T, typename A>
+        void post(task<T, A> t) {
+            outstanding.fetch_add(1, std::memory_order_relaxed);
+            post(run_job(*this, std::move(t)).coro);
+        }
+
+
+        /// ### Wait for all posted tasks to complete
+        /**
+         * Blocks the calling thread, so must not be used from one of the
+         * worker threads. Re-throws the first exception that any of the tasks
+         * posted since the last `wait` threw.
+         */
+        void wait() {
+            std::unique_lock lock{mtx};
+            idle.wait(lock, [this]() {
+                return outstanding.load(std::memory_order_acquire) == 0;
+            });
+            if (auto e = std::exchange(first_error, {}); e) {
+                std::rethrow_exception(e);
+            }
+        }
+    };
+
+
+}
@@ -0,0 +1,434 @@
+#pragma once
+
+
+#include <felspar/coro/coroutine.hpp>
+#include <felspar/coro/executor.hpp>
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+
+namespace felspar::coro {
+
+
+    /// ## A pending timer
+    /**
+     * Timers are intrusive, the awaitables that wait on the wheel embed one of
+     * these so that scheduling and cancelling never allocates. A node must not
+     * be moved whilst it is scheduled. When it fires `fired` is set and, if
+     * there is one, the handle is resumed.
+     */
+    struct timer_node {
+        std::uint64_t expiry = {};
+        timer_node *next = nullptr, **pprev = nullptr;
+        std::coroutine_handle<> handle = {};
+        bool fired = false;
+
+        bool scheduled() const noexcept { return pprev != nullptr; }
+    };
+
+
+    /// ## Hierarchical timer wheel
+    /**
+     * Time is divided into ticks of a fixed resolution (one millisecond by
+     * default) and timers are placed in one of 64 slots in one of several
+     * levels depending on how far away they are, with each level covering 64
+     * times the span of the one below. Scheduling and cancelling a timer are
+     * O(1). As time advances into a new slot of a higher level the timers in
+     * it are moved down to the lower levels, and timers in the lowest level
+     * fire as their slot is reached.
+     *
+     * Nothing happens until the wheel is told the time has moved on by
+     * calling `advance`, which will normally be done from an event loop. The
+     * `next_wakeup` member gives the time by which that should be done.
+     * Timers fire at the first `advance` at or after their deadline, rounded
+     * up to the resolution.
+     *
+     * Expired coroutines are resumed from inside `advance` unless the wheel
+     * has been given an [executor](./executor.hpp). There is no thread
+     * synchronisation.
+     */
+    class timer_wheel final {
+      public:
+        using clock = std::chrono::steady_clock;
+        using duration = clock::duration;
+        using time_point = clock::time_point;
+
+
+      private:
+        static constexpr std::size_t slot_bits = 6, slots = 1u << slot_bits,
+                                     levels = 6;
+        static constexpr std::uint64_t horizon = std::uint64_t{1}
+                << (slot_bits * levels);
+
+        duration const resolution;
+        time_point const origin;
+        std::uint64_t current = {};
+        std::size_t pending = {};
+        executor *exec = nullptr;
+
+        std::array<std::array<timer_node *, slots>, levels> wheel = {};
+        std::array<std::uint64_t, levels> occupied = {};
+
+
+        static std::size_t slot_of(std::uint64_t tick, std::size_t level) {
+            return (tick >> (slot_bits * level)) & (slots - 1);
+        }
+        std::uint64_t ticks_until(time_point const tp) const noexcept {
+            if (tp <= origin) { return 0; }
+            auto const d = tp - origin;
+            return static_cast<std::uint64_t>(
+                    (d + resolution - duration{1}) / resolution);
+        }
+        std::uint64_t ticks_at(time_point const tp) const noexcept {
+            if (tp <= origin) { return 0; }
+            return static_cast<std::uint64_t>((tp - origin) / resolution);
+        }
+
+        void link(timer_node &n) {
+            auto const delta = n.expiry > current ? n.expiry - current : 0;
+            std::size_t level{};
+            std::uint64_t placement = n.expiry;
+            if (delta >= horizon) {
+                level = levels - 1;
+                placement = current + horizon - 1;
+            } else {
+                while (delta >> (slot_bits * (level + 1))) { ++level; }
+            }
+            auto const index = slot_of(placement, level);
+            auto &head = wheel[level][index];
+            n.next = head;
+            if (head) { head->pprev = &n.next; }
+            head = &n;
+            n.pprev = &head;
+            occupied[level] |= std::uint64_t{1} << index;
+        }
+        void unlink(timer_node &n) noexcept {
+            *n.pprev = n.next;
+            if (n.next) { n.next->pprev = n.pprev; }
+            if (*n.pprev == nullptr) {
+                /// If the node was the last in a wheel slot then clear its
+                /// occupancy bit
+                auto *const first = &wheel[0][0];
+                auto *const last = first + levels * slots;
+                if (not std::less<>{}(n.pprev, first)
+                    and std::less<>{}(n.pprev, last)) {
+                    auto const offset =
+                            static_cast<std::size_t>(n.pprev - first);
+                    occupied[offset / slots] &=
+                            ~(std::uint64_t{1} << (offset % slots));
+                }
+            }
+            n.next = nullptr;
+            n.pprev = nullptr;
+        }
+
+        /// Take a whole slot as a list whose head is `into`
+        void take(std::size_t level, std::size_t index, timer_node *&into) {
+            into = std::exchange(wheel[level][index], nullptr);
+            if (into) { into->pprev = &into; }
+            occupied[level] &= ~(std::uint64_t{1} << index);
+        }
+
+        void cascade(std::size_t const level) {
+            auto const index = slot_of(current, level);
+            if (index == 0 and level + 1 < levels) { cascade(level + 1); }
+            timer_node *list = nullptr;
+            take(level, index, list);
+            while (list) {
+                auto &n = *list;
+                unlink(n);
+                link(n);
+            }
+        }
+
+        std::size_t fire() {
+            timer_node *list = nullptr;
+            take(0, slot_of(current, 0), list);
+            std::size_t count{};
+            while (list) {
+                /// Unlinking each node before it fires allows the resumed
+                /// coroutines to cancel any of the others
+                auto &n = *list;
+                unlink(n);
+                --pending;
+                ++count;
+                n.fired = true;
+                if (n.handle) { resume_on(exec, n.handle); }
+            }
+            return count;
+        }
+
+
+        /// Stands in for the coroutine waiting on `with_deadline` when the
+        /// wheel has an executor. A fired timer has already posted the
+        /// coroutine, so the relay only continues it if the timer hasn't
+        /// fired, cancelling the timer as it does
+        struct relay {
+            struct promise_type {
+                relay get_return_object() {
+                    return {unique_handle<promise_type>::from_promise(*this)};
+                }
+                std::suspend_always initial_suspend() const noexcept {
+                    return {};
+                }
+                std::suspend_always final_suspend() const noexcept {
+                    return {};
+                }
+                void return_void() const noexcept {}
+                void unhandled_exception() const noexcept { std::terminate(); }
+            };
+            unique_handle<promise_type> coro;
+        };
+        static relay relay_to(timer_wheel &wheel, timer_node &node) {
+            struct claim {
+                timer_wheel &wheel;
+                timer_node &node;
+
+                bool await_ready() const noexcept { return false; }
+                std::coroutine_handle<>
+                        await_suspend(std::coroutine_handle<>) const noexcept {
+                    if (node.fired) {
+                        return std::noop_coroutine();
+                    } else {
+                        wheel.cancel(node);
+                        return node.handle;
+                    }
+                }
+                void await_resume() const noexcept {}
+            };
+            while (true) { co_await claim{wheel, node}; }
+        }
+
+
+      public:
+        /// ### Construction
+        explicit timer_wheel(
+                duration const r = std::chrono::milliseconds{1},
+                time_point const start = clock::now())
+        : resolution{r}, origin{start} {}
+        timer_wheel(duration const r, executor &e)
+        : timer_wheel{r} {
+            exec = &e;
+        }
+        timer_wheel(timer_wheel const &) = delete;
+        timer_wheel(timer_wheel &&) = delete;
+        timer_wheel &operator=(timer_wheel const &) = delete;
+        timer_wheel &operator=(timer_wheel &&) = delete;
+
+
+        /// ### Query the wheel
+
+        /// #### The number of pending timers
+        [[nodiscard]] std::size_t size() const noexcept { return pending; }
+        [[nodiscard]] bool empty() const noexcept { return pending == 0; }
+
+        /// #### The time the wheel has been advanced to
+        [[nodiscard]] time_point now() const noexcept {
+            return origin + resolution * current;
+        }
+
+        /// #### When `advance` next needs to be called
+        /**
+         * Empty if there are no pending timers. The time given may be that of
+         * timers moving down a level rather than of them firing, so there may
+         * not be anything ready at that time.
+         */
+        [[nodiscard]] std::optional<time_point> next_wakeup() const noexcept {
+            if (not pending) { return {}; }
+            std::uint64_t earliest = std::numeric_limits<std::uint64_t>::max();
+            for (std::size_t level{}; level < levels; ++level) {
+                if (not occupied[level]) { continue; }
+                auto const base = current >> (slot_bits * level);
+                auto const from = static_cast<int>((base + 1) & (slots - 1));
+                auto const distance =
+                        std::countr_zero(std::rotr(occupied[level], from)) + 1;
+                auto const tick = (base + static_cast<std::uint64_t>(distance))
+                        << (slot_bits * level);
+                if (tick < earliest) { earliest = tick; }
+            }
+            return origin + resolution * earliest;
+        }
+
+
+        /// ### Advance time
+        /**
+         * Moves the wheel on to the given time, firing every timer whose
+         * deadline has been reached. Returns the number of timers that fired.
+         */
+        std::size_t advance(time_point const to = clock::now()) {
+            auto const target = ticks_at(to);
+            std::size_t count{};
+            while (current < target) {
+                if (not pending) {
+                    current = target;
+                    break;
+                }
+                /// Skip directly to the next occupied slot in the lowest
+                /// level, or the start of its next rotation, whichever is first
+                auto const index = slot_of(current, 0);
+                auto const later = index + 1 < slots
+                        ? occupied[0] & (~std::uint64_t{} << (index + 1))
+                        : std::uint64_t{};
+                std::uint64_t next = later
+                        ? (current & ~std::uint64_t{slots - 1})
+                                + static_cast<std::uint64_t>(
+                                        std::countr_zero(later))
+                        : (current | (slots - 1)) + 1;
+                current = next < target ? next : target;
+                if (slot_of(current, 0) == 0) { cascade(1); }
+                count += fire();
+            }
+            return count;
+        }
+
+
+        /// ### Schedule and cancel a timer
+        /**
+         * The node's handle is resumed once the tick it is scheduled for has
+         * been reached. A node whose tick has already passed fires at the next
+         * call to `advance`.
+         */
+        void schedule(timer_node &n, time_point const deadline) {
+            if (n.scheduled()) { cancel(n); }
+            n.expiry = ticks_until(deadline);
+            if (n.expiry <= current) { n.expiry = current + 1; }
+            n.fired = false;
+            link(n);
+            ++pending;
+        }
+        void cancel(timer_node &n) noexcept {
+            if (n.scheduled()) {
+                unlink(n);
+                --pending;
+            }
+        }
+
+
+        /// ### Sleep
+        FELSPAR_CORO_WRAPPER auto sleep_until(time_point const deadline) {
+            struct FELSPAR_CORO_CRT awaitable {
+                awaitable(timer_wheel &w, time_point d)
+                : wheel{w}, deadline{d} {}
+                awaitable(awaitable const &) = delete;
+                awaitable(awaitable &&) = delete;
+                ~awaitable() { wheel.cancel(node); }
+
+                awaitable &operator=(awaitable const &) = delete;
+                awaitable &operator=(awaitable &&) = delete;
+
+
+                timer_wheel &wheel;
+                time_point deadline;
+                timer_node node = {};
+
+
+                bool await_ready() const noexcept {
+                    return wheel.ticks_until(deadline) <= wheel.current;
+                }
+                void await_suspend(std::coroutine_handle<> h) {
+                    node.handle = h;
+                    wheel.schedule(node, deadline);
+                }
+                void await_resume() const noexcept {}
+            };
+            return awaitable{*this, deadline};
+        }
+        FELSPAR_CORO_WRAPPER auto sleep_for(duration const d) {
+            return sleep_until(clock::now() + d);
+        }
+
+
+        /// ### Time out any awaitable
+        /**
+         * Waits on the awaitable until it completes or the deadline is
+         * reached, whichever happens first. The result is a `bool` that is
+         * true if a `void` awaitable completed, otherwise a `std::optional`
+         * holding (a copy of) the awaitable's result. When the timeout is
+         * reached the awaitable is destroyed without being resumed. For a
+         * `task` this destroys the task, and for a `stream` any value it goes
+         * on to yield is lost.
+         *
+         * If the wheel has an executor then the awaitable may still complete
+         * after the timer has fired but before the executor continues the
+         * coroutine. So that the coroutine is only continued once, the
+         * awaitable is then given a small relay coroutine to resume rather
+         * than the waiting coroutine itself, which costs an allocation.
+         */
+        template<typename A>
+        FELSPAR_CORO_WRAPPER auto
+                with_deadline(A &&a, time_point const deadline) {
+            using inner_type = awaiter_type<A>;
+            using result_type = decltype(std::declval<inner_type &>().await_resume());
+            using value_type = std::conditional_t<
+                    std::is_void_v<result_type>, bool,
+                    std::optional<std::remove_cvref_t<result_type>>>;
+
+            struct FELSPAR_CORO_CRT awaitable {
+                awaitable(timer_wheel &w, A &&a, time_point d)
+                : inner{get_awaiter(std::forward<A>(a))}, wheel{w}, deadline{d} {}
+                awaitable(awaitable const &) = delete;
+                awaitable(awaitable &&) = delete;
+                ~awaitable() { wheel.cancel(node); }
+
+                awaitable &operator=(awaitable const &) = delete;
+                awaitable &operator=(awaitable &&) = delete;
+
+
+                /// Destroyed after the awaitable that might resume it
+                relay claimant = {};
+                inner_type inner;
+                timer_wheel &wheel;
+                time_point deadline;
+                timer_node node = {};
+
+
+                bool await_ready() {
+                    if (inner.await_ready()) {
+                        return true;
+                    } else if (wheel.ticks_until(deadline) <= wheel.current) {
+                        node.fired = true;
+                        return true;
+                    } else {
+                        return false;
+                    }
+                }
+                decltype(auto) await_suspend(std::coroutine_handle<> h) {
+                    node.handle = h;
+                    wheel.schedule(node, deadline);
+                    if (wheel.exec) {
+                        claimant = relay_to(wheel, node);
+                        return inner.await_suspend(claimant.coro.get());
+                    } else {
+                        return inner.await_suspend(h);
+                    }
+                }
+                value_type await_resume() {
+                    wheel.cancel(node);
+                    if constexpr (std::is_void_v<result_type>) {
+                        if (node.fired) { return false; }
+                        inner.await_resume();
+                        return true;
+                    } else {
+                        if (node.fired) { return {}; }
+                        return inner.await_resume();
+                    }
+                }
+            };
+            return awaitable{*this, std::forward<A>(a), deadline};
+        }
+        template<typename A>
+        FELSPAR_CORO_WRAPPER auto with_timeout(A &&a, duration const d) {
+            return with_deadline(std::forward<A>(a), clock::now() + d);
+        }
+    };
+
+
+}
@@ -0,0 +1,476 @@
+#pragma once
+
+
+#include <felspar/coro/task.hpp>
+#include <felspar/exceptions.hpp>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <span>
+#include <string>
+#include <system_error>
+
+
+namespace felspar::coro {
+
+
+    /// ## io_uring reactor
+    /**
+     * Awaitable file and socket operations backed by Linux's io_uring. The
+     * operations only place a submission queue entry in the ring when they are
+     * awaited. All queued entries are then submitted together by a single
+     * `io_uring_enter` call the next time the reactor is run, which also
+     * collects completions and resumes the coroutines waiting on them.
+     *
+     * Operations return the (non-negative) result of the underlying system
+     * call, and throw a `std::system_error` if it failed. A coroutine must not
+     * be destroyed whilst it has an operation in flight, as the kernel will
+     * still write the completion (and for reads the data) into it.
+     *
+     * There is no thread synchronisation. The reactor must be run from the
+     * thread whose coroutines are using it.
+     */
+    class uring final {
+      public:
+        /// ### Registered files
+        /// A file registered using `register_files`, identified by its index
+        struct registered_file {
+            unsigned index;
+        };
+
+        /// ### The target of an operation
+        /// Either a plain file descriptor or a registered file
+        struct file {
+            file(int const fd) : number{fd} {}
+            file(registered_file const r)
+            : number{static_cast<int>(r.index)}, fixed{true} {}
+
+            int number;
+            bool fixed = false;
+        };
+
+
+      private:
+        /// Closes the ring's file descriptor
+        struct descriptor {
+            int fd = -1;
+
+            descriptor() = default;
+            descriptor(descriptor const &) = delete;
+            descriptor &operator=(descriptor const &) = delete;
+            ~descriptor() {
+                if (fd >= 0) { ::close(fd); }
+            }
+        };
+        /// Unmaps one of the ring's shared memory regions
+        struct mapping {
+            void *ptr = nullptr;
+            std::size_t size = {};
+
+            mapping() = default;
+            mapping(mapping const &) = delete;
+            mapping &operator=(mapping const &) = delete;
+            ~mapping() {
+                if (ptr) { ::munmap(ptr, size); }
+            }
+        };
+
+        /// Declared in the order they're set up, so that if construction
+        /// fails part way through whatever has been set up is released
+        descriptor ring_fd;
+        io_uring_params params = {};
+        mapping sq_ring, cq_ring, sqe_ring;
+
+        io_uring_sqe *sqes = nullptr;
+
+        unsigned *sq_head = nullptr, *sq_tail = nullptr, *sq_array = nullptr;
+        unsigned sq_mask = {};
+        unsigned *cq_head = nullptr, *cq_tail = nullptr;
+        unsigned cq_mask = {};
+        io_uring_cqe *cqes = nullptr;
+
+        unsigned local_tail = {}, queued = {};
+        std::size_t in_flight = {};
+
+
+        static void throw_error(
+                int const error,
+                char const *what,
+                std::source_location const &loc) {
+            throw std::system_error{
+                    error, std::system_category(),
+                    std::string{what} + " at " + loc.file_name() + ":"
+                            + std::to_string(loc.line())};
+        }
+
+        template<typename T>
+        static T *offset(void *base, std::uint32_t const off) noexcept {
+            return reinterpret_cast<T *>(static_cast<std::byte *>(base) + off);
+        }
+        void map(mapping &m, std::size_t const size, off_t const off) {
+            void *const p =
+                    ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, ring_fd.fd, off);
+            if (p == MAP_FAILED) {
+                throw_error(errno, "mmap", std::source_location::current());
+            }
+            m.ptr = p;
+            m.size = size;
+        }
+
+        int enter(unsigned const submit, unsigned const wait) {
+            while (true) {
+                auto const r = ::syscall(
+                        __NR_io_uring_enter, ring_fd.fd, submit, wait,
+                        wait ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+                if (r >= 0) {
+                    return static_cast<int>(r);
+                } else if (errno != EINTR) {
+                    throw_error(
+                            errno, "io_uring_enter",
+                            std::source_location::current());
+                }
+            }
+        }
+
+        /// Make the queued entries visible to the kernel
+        unsigned publish() noexcept {
+            std::atomic_ref<unsigned>{*sq_tail}.store(
+                    local_tail, std::memory_order_release);
+            return std::exchange(queued, 0u);
+        }
+
+        io_uring_sqe &next_sqe() {
+            auto const head = std::atomic_ref<unsigned>{*sq_head}.load(
+                    std::memory_order_acquire);
+            if (local_tail - head == params.sq_entries) {
+                /// The submission queue is full so it has to be submitted now
+                enter(publish(), 0);
+                return next_sqe();
+            }
+            auto const index = local_tail & sq_mask;
+            sq_array[index] = index;
+            ++local_tail;
+            ++queued;
+            std::memset(&sqes[index], 0, sizeof(io_uring_sqe));
+            return sqes[index];
+        }
+
+        /// Resume the coroutines of any completed operations
+        std::size_t reap();
+
+
+        struct completion {
+            std::coroutine_handle<> handle = {};
+            int result = {};
+        };
+
+        static void
+                prepare(io_uring_sqe &sqe,
+                        __u8 const opcode,
+                        file const f,
+                        void const *const address,
+                        std::size_t const length,
+                        std::uint64_t const offset) noexcept {
+            sqe.opcode = opcode;
+            sqe.fd = f.number;
+            if (f.fixed) { sqe.flags |= IOSQE_FIXED_FILE; }
+            sqe.addr = reinterpret_cast<std::uintptr_t>(address);
+            sqe.len = static_cast<__u32>(length);
+            sqe.off = offset;
+        }
+
+        template<typename Prepare>
+        auto operation(std::source_location const &loc, Prepare prepare) {
+            struct FELSPAR_CORO_CRT awaitable {
+                uring &ring;
+                Prepare prepare;
+                std::source_location loc;
+                completion done = {};
+
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<> h) {
+                    done.handle = h;
+                    auto &sqe = ring.next_sqe();
+                    prepare(sqe);
+                    sqe.user_data = reinterpret_cast<std::uintptr_t>(&done);
+                    ++ring.in_flight;
+                }
+                int await_resume() const {
+                    if (done.result < 0) {
+                        throw_error(-done.result, "io_uring operation", loc);
+                    }
+                    return done.result;
+                }
+            };
+            return awaitable{*this, std::move(prepare), loc};
+        }
+
+
+      public:
+        /// ### Construction
+        explicit uring(
+                unsigned const entries = 256,
+                std::source_location const &loc =
+                        std::source_location::current()) {
+            auto const fd =
+                    ::syscall(__NR_io_uring_setup, entries, &params);
+            if (fd < 0) { throw_error(errno, "io_uring_setup", loc); }
+            ring_fd.fd = static_cast<int>(fd);
+
+            std::size_t sq_size = params.sq_off.array
+                    + params.sq_entries * sizeof(unsigned);
+            std::size_t cq_size = params.cq_off.cqes
+                    + params.cq_entries * sizeof(io_uring_cqe);
+            if (params.features & IORING_FEAT_SINGLE_MMAP) {
+                sq_size = cq_size = std::max(sq_size, cq_size);
+            }
+            map(sq_ring, sq_size, IORING_OFF_SQ_RING);
+            /// With a single mapping `cq_ring` stays empty
+            void *const sq_ptr = sq_ring.ptr;
+            void *cq_ptr = sq_ptr;
+            if (not(params.features & IORING_FEAT_SINGLE_MMAP)) {
+                map(cq_ring, cq_size, IORING_OFF_CQ_RING);
+                cq_ptr = cq_ring.ptr;
+            }
+            map(sqe_ring, params.sq_entries * sizeof(io_uring_sqe),
+                IORING_OFF_SQES);
+            sqes = static_cast<io_uring_sqe *>(sqe_ring.ptr);
+
+            sq_head = offset<unsigned>(sq_ptr, params.sq_off.head);
+            sq_tail = offset<unsigned>(sq_ptr, params.sq_off.tail);
+            sq_mask = *offset<unsigned>(sq_ptr, params.sq_off.ring_mask);
+            sq_array = offset<unsigned>(sq_ptr, params.sq_off.array);
+            cq_head = offset<unsigned>(cq_ptr, params.cq_off.head);
+            cq_tail = offset<unsigned>(cq_ptr, params.cq_off.tail);
+            cq_mask = *offset<unsigned>(cq_ptr, params.cq_off.ring_mask);
+            cqes = offset<io_uring_cqe>(cq_ptr, params.cq_off.cqes);
+            local_tail = *sq_tail;
+        }
+        uring(uring const &) = delete;
+        uring(uring &&) = delete;
+        uring &operator=(uring const &) = delete;
+        uring &operator=(uring &&) = delete;
+
+
+        /// ### Registered resources
+
+        /// #### Registered buffers
+        /// Used by `read_fixed` and `write_fixed` through their index
+        void register_buffers(
+                std::span<::iovec const> const buffers,
+                std::source_location const &loc =
+                        std::source_location::current()) {
+            if (::syscall(__NR_io_uring_register, ring_fd.fd,
+                          IORING_REGISTER_BUFFERS, buffers.data(),
+                          static_cast<unsigned>(buffers.size()))
+                < 0) {
+                throw_error(errno, "io_uring_register buffers", loc);
+            }
+        }
+
+        /// #### Registered files
+        /// Operations use them by passing a `registered_file` in place of the
+        /// file descriptor
+        void register_files(
+                std::span<int const> const fds,
+                std::source_location const &loc =
+                        std::source_location::current()) {
+            if (::syscall(__NR_io_uring_register, ring_fd.fd,
+                          IORING_REGISTER_FILES, fds.data(),
+                          static_cast<unsigned>(fds.size()))
+                < 0) {
+                throw_error(errno, "io_uring_register files", loc);
+            }
+        }
+        /// ### Operations
+        FELSPAR_CORO_WRAPPER auto
+                read(file const f,
+                     std::span<std::byte> const buffer,
+                     std::uint64_t const offset,
+                     std::source_location const &loc =
+                             std::source_location::current()) {
+            return operation(loc, [=](io_uring_sqe &sqe) {
+                prepare(sqe, IORING_OP_READ, f, buffer.data(), buffer.size(),
+                        offset);
+            });
+        }
+        FELSPAR_CORO_WRAPPER auto
+                write(file const f,
+                      std::span<std::byte const> const buffer,
+                      std::uint64_t const offset,
+                      std::source_location const &loc =
+                              std::source_location::current()) {
+            return operation(loc, [=](io_uring_sqe &sqe) {
+                prepare(sqe, IORING_OP_WRITE, f, buffer.data(), buffer.size(),
+                        offset);
+            });
+        }
+        FELSPAR_CORO_WRAPPER auto read_fixed(
+                file const f,
+                std::span<std::byte> const buffer,
+                std::uint64_t const offset,
+                unsigned const buffer_index,
+                std::source_location const &loc =
+                        std::source_location::current()) {
+            return operation(loc, [=](io_uring_sqe &sqe) {
+                prepare(sqe, IORING_OP_READ_FIXED, f, buffer.data(),
+                        buffer.size(), offset);
+                sqe.buf_index = static_cast<__u16>(buffer_index);
+            });
+        }
+        FELSPAR_CORO_WRAPPER auto write_fixed(
+                file const f,
+                std::span<std::byte const> const buffer,
+                std::uint64_t const offset,
+                unsigned const buffer_index,
+                std::source_location const &loc =
+                        std::source_location::current()) {
+            return operation(loc, [=](io_uring_sqe &sqe) {
+                prepare(sqe, IORING_OP_WRITE_FIXED, f, buffer.data(),
+                        buffer.size(), offset);
+                sqe.buf_index = static_cast<__u16>(buffer_index);
+            });
+        }
+        FELSPAR_CORO_WRAPPER auto
+                recv(file const f,
+                     std::span<std::byte> const buffer,
+                     int const flags = 0,
+                     std::source_location const &loc =
+                             std::source_location::current()) {
+            return operation(loc, [=](io_uring_sqe &sqe) {
+                prepare(sqe, IORING_OP_RECV, f, buffer.data(), buffer.size(),
+                        0);
+                sqe.msg_flags = static_cast<__u32>(flags);
+            });
+        }
+        FELSPAR_CORO_WRAPPER auto
+                send(file const f,
+                     std::span<std::byte const> const buffer,
+                     int const flags = 0,
+                     std::source_location const &loc =
+                             std::source_location::current()) {
+            return operation(loc, [=](io_uring_sqe &sqe) {
+                prepare(sqe, IORING_OP_SEND, f, buffer.data(), buffer.size(),
+                        0);
+                sqe.msg_flags = static_cast<__u32>(flags);
+            });
+        }
+        FELSPAR_CORO_WRAPPER auto
+                accept(file const f,
+                       ::sockaddr *const address = nullptr,
+                       ::socklen_t *const length = nullptr,
+                       int const flags = 0,
+                       std::source_location const &loc =
+                               std::source_location::current()) {
+            return operation(loc, [=](io_uring_sqe &sqe) {
+                prepare(sqe, IORING_OP_ACCEPT, f, address, 0,
+                        reinterpret_cast<std::uintptr_t>(length));
+                sqe.accept_flags = static_cast<__u32>(flags);
+            });
+        }
+        FELSPAR_CORO_WRAPPER auto
+                connect(file const f,
+                        ::sockaddr const *const address,
+                        ::socklen_t const length,
+                        std::source_location const &loc =
+                                std::source_location::current()) {
+            return operation(loc, [=](io_uring_sqe &sqe) {
+                prepare(sqe, IORING_OP_CONNECT, f, address, 0, length);
+            });
+        }
+        FELSPAR_CORO_WRAPPER auto
+                fsync(file const f,
+                      unsigned const flags = 0,
+                      std::source_location const &loc =
+                              std::source_location::current()) {
+            return operation(loc, [=](io_uring_sqe &sqe) {
+                prepare(sqe, IORING_OP_FSYNC, f, nullptr, 0, 0);
+                sqe.fsync_flags = flags;
+            });
+        }
+        FELSPAR_CORO_WRAPPER auto
+                close(int const fd,
+                      std::source_location const &loc =
+                              std::source_location::current()) {
+            return operation(loc, [=](io_uring_sqe &sqe) {
+                prepare(sqe, IORING_OP_CLOSE, fd, nullptr, 0, 0);
+            });
+        }
+
+
+        /// ### Running the reactor
+
+        /// #### The number of operations that are queued or in flight
+        [[nodiscard]] std::size_t outstanding() const noexcept {
+            return in_flight;
+        }
+
+        /// #### Submit and complete operations
+        /**
+         * Submits everything that has been queued with a single system call,
+         * optionally waiting for at least one completion (only if there is
+         * something outstanding). Then resumes the coroutines of all of the
+         * completed operations. Returns the number of operations completed.
+         */
+        std::size_t run_once(bool const wait = true) {
+            auto const submit = publish();
+            if (submit or (wait and in_flight)) {
+                enter(submit, wait and in_flight ? 1u : 0u);
+            }
+            return reap();
+        }
+
+        /// #### Run a task to completion
+        /// Runs the reactor for as long as the task needs it
+        template<typename T, typename A>
+        T run(task<T, A> t,
+              std::source_location const &loc =
+                      std::source_location::current()) {
+            auto coro = t.release();
+            coro.promise().started = true;
+            coro.resume();
+            while (not coro.done()) {
+                if (not in_flight) {
+                    throw stdexcept::logic_error{
+                            "The task is waiting, but there is no I/O in "
+                            "flight that could complete it",
+                            loc};
+                }
+                run_once();
+            }
+            return coro.promise().consume_value();
+        }
+    };
+
+
+    inline std::size_t uring::reap() {
+        std::size_t count{};
+        auto head = *cq_head;
+        while (head
+               != std::atomic_ref<unsigned>{*cq_tail}.load(
+                       std::memory_order_acquire)) {
+            auto const &cqe = cqes[head & cq_mask];
+            auto *const c = reinterpret_cast<completion *>(cqe.user_data);
+            c->result = cqe.res;
+            ++head;
+            std::atomic_ref<unsigned>{*cq_head}.store(
+                    head, std::memory_order_release);
+            --in_flight;
+            ++count;
+            c->handle.resume();
+        }
+        return count;
+    }
+
+
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+
+#include <felspar/coro/coroutine.hpp>
+
+#include <cstddef>
+
+
+namespace felspar::coro {
+
+
+    class waiter_list;
+
+
+    /// ## A waiting coroutine
+    /**
+     * Awaitables that need to park their coroutine embed one of these (or a
+     * type derived from it). The awaitable must not be moved whilst it is in a
+     * list, and should remove itself from the list in its destructor.
+     */
+    struct waiter_node {
+        std::coroutine_handle<> handle = {};
+        waiter_node *prev = nullptr, *next = nullptr;
+        /// The list the node is currently in, if any
+        waiter_list *list = nullptr;
+    };
+
+
+    /// ## Intrusive FIFO list of waiting coroutines
+    /**
+     * Adding and removing nodes is O(1) and never allocates. The list does not
+     * own the nodes, but each node knows which list it is in, so moving a
+     * list is linear in its length.
+     */
+    class waiter_list final {
+        waiter_node *first = nullptr, *last = nullptr;
+
+        /// Unlink all of the nodes, which are then in no list
+        void detach_all() noexcept {
+            while (first) {
+                auto *const n = std::exchange(first, first->next);
+                n->prev = n->next = nullptr;
+                n->list = nullptr;
+            }
+            last = nullptr;
+        }
+        /// Take over the nodes of another list
+        void adopt(waiter_list &o) noexcept {
+            first = std::exchange(o.first, nullptr);
+            last = std::exchange(o.last, nullptr);
+            for (auto *n = first; n; n = n->next) { n->list = this; }
+        }
+        void push_front(waiter_node &n) noexcept {
+            n.prev = nullptr;
+            n.next = first;
+            n.list = this;
+            if (first) {
+                first->prev = &n;
+            } else {
+                last = &n;
+            }
+            first = &n;
+        }
+
+      public:
+        waiter_list() = default;
+        waiter_list(waiter_list &&o) noexcept { adopt(o); }
+        waiter_list(waiter_list const &) = delete;
+        /// Any nodes still in the list are left in no list, so removing
+        /// them later does nothing
+        ~waiter_list() { detach_all(); }
+
+        waiter_list &operator=(waiter_list &&o) noexcept {
+            if (this != &o) {
+                detach_all();
+                adopt(o);
+            }
+            return *this;
+        }
+        waiter_list &operator=(waiter_list const &) = delete;
+
+
+        /// ### Query the list
+        [[nodiscard]] bool empty() const noexcept { return first == nullptr; }
+        [[nodiscard]] waiter_node *front() const noexcept { return first; }
+
+
+        /// ### Add a node to the end of the list
+        void push_back(waiter_node &n) noexcept {
+            n.prev = last;
+            n.next = nullptr;
+            n.list = this;
+            if (last) {
+                last->next = &n;
+            } else {
+                first = &n;
+            }
+            last = &n;
+        }
+
+        /// ### Remove the first node
+        /// Returns `nullptr` if the list is empty
+        waiter_node *pop_front() noexcept {
+            auto *const n = first;
+            if (n) { remove(*n); }
+            return n;
+        }
+
+        /// ### Remove the nodes currently in the list
+        /**
+         * Each node in the list at the time of the call is removed and passed
+         * to `f`, which will normally resume its coroutine. The nodes are
+         * moved out of the list before any are passed to `f`, so nodes added
+         * by `f` (including by a nested `drain`) are left in the list. Nodes
+         * that are removed before they're reached are skipped, and if `f`
+         * throws then the nodes not yet reached are put back at the front of
+         * the list. Returns the number of nodes passed to `f`.
+         */
+        template<typename F>
+        std::size_t drain(F f) {
+            struct pending_nodes {
+                waiter_list &list;
+                waiter_list nodes;
+                ~pending_nodes() {
+                    while (nodes.last) {
+                        auto *const n = nodes.last;
+                        nodes.remove(*n);
+                        list.push_front(*n);
+                    }
+                }
+            } pending{*this, std::move(*this)};
+            std::size_t count{};
+            while (auto *const n = pending.nodes.pop_front()) {
+                f(*n);
+                ++count;
+            }
+            return count;
+        }
+
+        /// ### Remove a node
+        /**
+         * The node is removed from whichever list it is in, which may be one
+         * that a `drain` has moved it to. Returns false if the node wasn't in
+         * this list.
+         */
+        bool remove(waiter_node &n) noexcept {
+            auto *const l = n.list;
+            if (not l) { return false; }
+            if (n.prev) {
+                n.prev->next = n.next;
+            } else {
+                l->first = n.next;
+            }
+            if (n.next) {
+                n.next->prev = n.prev;
+            } else {
+                l->last = n.prev;
+            }
+            n.prev = n.next = nullptr;
+            n.list = nullptr;
+            return l == this;
+        }
+
+    };
+
+}
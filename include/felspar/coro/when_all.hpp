@@ -0,0 +1,131 @@
+#pragma once
+
+
+#include <felspar/coro/task.hpp>
+
+#include <tuple>
+#include <variant>
+#include <vector>
+
+
+namespace felspar::coro {
+
+
+    /// ## The result of a task when several are awaited together
+    /// `void` tasks are represented by `std::monostate`
+    template<typename T>
+    using task_result_type = std::conditional_t<
+            std::is_void_v<typename T::value_type>,
+            std::monostate,
+            typename T::value_type>;
+
+    template<typename H>
+    inline auto consume_task_result(H &h) {
+        if constexpr (std::is_void_v<
+                              typename std::remove_cvref_t<
+                                      decltype(h.promise())>::value_type>) {
+            h.promise().consume_value();
+            return std::monostate{};
+        } else {
+            return h.promise().consume_value();
+        }
+    }
+
+
+    /// ## Await several tasks concurrently
+    /**
+     * All of the tasks are started when the result of `when_all` is awaited.
+     * The awaiting coroutine is continued once they have all completed, and
+     * the result is a tuple of their results (with `std::monostate` for a
+     * `void` task). If any of the tasks threw, the exception from the first
+     * one (in argument order) is re-thrown once they have all completed.
+     *
+     * The only shared state is a [`task_group`](./task.hpp) held in the
+     * awaitable, so no coroutine frames are needed beyond the tasks' own. The
+     * tasks may complete on other threads, in which case the awaiting
+     * coroutine is continued on the thread of the last one to complete.
+     */
+    template<typename... Ts, typename... As>
+    FELSPAR_CORO_WRAPPER auto when_all(task<Ts, As>... tasks) {
+        struct FELSPAR_CORO_CRT awaitable {
+            std::tuple<typename task<Ts, As>::unique_handle_type...> coros;
+            task_group group = {};
+
+            awaitable(typename task<Ts, As>::unique_handle_type... hs)
+            : coros{std::move(hs)...} {}
+            awaitable(awaitable const &) = delete;
+            awaitable(awaitable &&) = delete;
+            awaitable &operator=(awaitable const &) = delete;
+            awaitable &operator=(awaitable &&) = delete;
+
+            bool await_ready() const noexcept { return sizeof...(Ts) == 0; }
+            bool await_suspend(std::coroutine_handle<> h) {
+                group.continuation = h;
+                group.remaining.store(
+                        sizeof...(Ts) + 1, std::memory_order_relaxed);
+                std::apply([this](auto &...c) { (group.join(c), ...); }, coros);
+                return group.remaining.fetch_sub(1, std::memory_order_acq_rel)
+                        != 1;
+            }
+            std::tuple<task_result_type<task<Ts, As>>...> await_resume() {
+                return std::apply(
+                        [](auto &...c) {
+                            return std::tuple<
+                                    task_result_type<task<Ts, As>>...>{
+                                    consume_task_result(c)...};
+                        },
+                        coros);
+            }
+        };
+        return awaitable{tasks.release()...};
+    }
+
+
+    /// ### A range of tasks
+    /**
+     * Returns a vector of the results in the same order as the tasks, or
+     * nothing for `void` tasks.
+     */
+    template<typename T, typename A>
+    FELSPAR_CORO_WRAPPER auto when_all(std::vector<task<T, A>> tasks) {
+        using handle_type = typename task<T, A>::unique_handle_type;
+        struct FELSPAR_CORO_CRT awaitable {
+            std::vector<handle_type> coros;
+            task_group group = {};
+
+            awaitable(std::vector<handle_type> hs) : coros{std::move(hs)} {}
+            awaitable(awaitable const &) = delete;
+            awaitable(awaitable &&) = delete;
+            awaitable &operator=(awaitable const &) = delete;
+            awaitable &operator=(awaitable &&) = delete;
+
+            bool await_ready() const noexcept { return coros.empty(); }
+            bool await_suspend(std::coroutine_handle<> h) {
+                group.continuation = h;
+                group.remaining.store(
+                        coros.size() + 1, std::memory_order_relaxed);
+                for (auto &c : coros) { group.join(c); }
+                return group.remaining.fetch_sub(1, std::memory_order_acq_rel)
+                        != 1;
+            }
+            auto await_resume() {
+                if constexpr (std::is_void_v<T>) {
+                    for (auto &c : coros) { c.promise().consume_value(); }
+                } else {
+                    std::vector<T> results;
+                    results.reserve(coros.size());
+                    for (auto &c : coros) {
+                        results.push_back(c.promise().consume_value());
+                    }
+                    return results;
+                }
+            }
+        };
+        std::vector<handle_type> handles;
+        handles.reserve(tasks.size());
+        for (auto &t : tasks) { handles.push_back(t.release()); }
+        return awaitable{std::move(handles)};
+    }
+
+
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+
+#include <felspar/coro/when_all.hpp>
+#include <felspar/exceptions.hpp>
+
+#include <optional>
+
+
+namespace felspar::coro {
+
+
+    /// ## Await the first of several tasks to complete
+    /**
+     * All of the tasks are started when the result of `when_any` is awaited,
+     * and the awaiting coroutine is continued as soon as any one of them has
+     * completed. Its result is that of the first task to complete, which
+     * needn't be the first to have done so by the time the awaiting coroutine
+     * continues, as the tasks may be running on other threads. If that task
+     * threw then its exception is re-thrown.
+     *
+     * The remaining tasks are not cancelled. Those that have been started
+     * are left to run until they complete, whatever they are waiting on and
+     * whichever thread they complete on, and their frames are destroyed when
+     * they do (their results are discarded). A task waiting on something
+     * that never happens is never destroyed. Tasks that were never started
+     * are destroyed along with the awaitable.
+     */
+    template<typename... Ts, typename... As>
+    FELSPAR_CORO_WRAPPER auto when_any(task<Ts, As>... tasks) {
+        static_assert(sizeof...(Ts) > 0, "when_any needs at least one task");
+        using result_type = std::variant<task_result_type<task<Ts, As>>...>;
+
+        struct FELSPAR_CORO_CRT awaitable {
+            std::tuple<typename task<Ts, As>::unique_handle_type...> coros;
+            task_group *group = task_group::make_shared();
+
+            awaitable(typename task<Ts, As>::unique_handle_type... hs)
+            : coros{std::move(hs)...} {}
+            awaitable(awaitable const &) = delete;
+            awaitable(awaitable &&) = delete;
+            ~awaitable() {
+                std::apply(
+                        [this](auto &...c) { (group->let_go(c), ...); }, coros);
+                group->release();
+            }
+            awaitable &operator=(awaitable const &) = delete;
+            awaitable &operator=(awaitable &&) = delete;
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> h) {
+                group->continuation = h;
+                group->remaining.store(2, std::memory_order_relaxed);
+                /// Starting stops once a task has completed, as there is no
+                /// need to start any more
+                std::apply(
+                        [this](auto &...c) {
+                            ((group->join(c), won()) or ...);
+                        },
+                        coros);
+                return group->remaining.fetch_sub(1, std::memory_order_acq_rel)
+                        != 1;
+            }
+            bool won() const noexcept {
+                return group->winner.load(std::memory_order_acquire);
+            }
+            /// Returns the variant holding the result of the first completed
+            /// task, so its index tells which task it was
+            result_type await_resume() {
+                std::size_t index{};
+                std::apply(
+                        [this, &index](auto &...c) {
+                            ((c.get().address() == group->winner.load()
+                              or (++index, false))
+                             or ...);
+                        },
+                        coros);
+                std::optional<result_type> result;
+                [&]<std::size_t... I>(std::index_sequence<I...>) {
+                    ((I == index
+                      and (result.emplace(
+                                   std::in_place_index<I>,
+                                   consume_task_result(std::get<I>(coros))),
+                           true))
+                     or ...);
+                }(std::index_sequence_for<Ts...>{});
+                return std::move(*result);
+            }
+        };
+        return awaitable{tasks.release()...};
+    }
+
+
+    /// ### A range of tasks
+    /**
+     * Returns a pair of the index of the task that completed first and its
+     * result, or just the index for `void` tasks.
+     */
+    template<typename T, typename A>
+    FELSPAR_CORO_WRAPPER auto when_any(
+            std::vector<task<T, A>> tasks,
+            std::source_location const &loc = std::source_location::current()) {
+        using handle_type = typename task<T, A>::unique_handle_type;
+        if (tasks.empty()) {
+            throw stdexcept::logic_error{"when_any needs at least one task", loc};
+        }
+        struct FELSPAR_CORO_CRT awaitable {
+            std::vector<handle_type> coros;
+            task_group *group = task_group::make_shared();
+
+            awaitable(std::vector<handle_type> hs) : coros{std::move(hs)} {}
+            awaitable(awaitable const &) = delete;
+            awaitable(awaitable &&) = delete;
+            ~awaitable() {
+                for (auto &c : coros) { group->let_go(c); }
+                group->release();
+            }
+            awaitable &operator=(awaitable const &) = delete;
+            awaitable &operator=(awaitable &&) = delete;
+
+            bool await_ready() const noexcept { return false; }
+            /// As above, no more tasks are started once one has completed
+            bool await_suspend(std::coroutine_handle<> h) {
+                group->continuation = h;
+                group->remaining.store(2, std::memory_order_relaxed);
+                for (auto &c : coros) {
+                    group->join(c);
+                    if (group->winner.load(std::memory_order_acquire)) {
+                        break;
+                    }
+                }
+                return group->remaining.fetch_sub(1, std::memory_order_acq_rel)
+                        != 1;
+            }
+            auto await_resume() {
+                std::size_t index{};
+                while (coros[index].get().address() != group->winner.load()) {
+                    ++index;
+                }
+                if constexpr (std::is_void_v<T>) {
+                    coros[index].promise().consume_value();
+                    return index;
+                } else {
+                    return std::pair<std::size_t, T>{
+                            index, coros[index].promise().consume_value()};
+                }
+            }
+        };
+        std::vector<handle_type> handles;
+        handles.reserve(tasks.size());
+        for (auto &t : tasks) { handles.push_back(t.release()); }
+        return awaitable{std::move(handles)};
+    }
+
+
+}
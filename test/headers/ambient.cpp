@@ -0,0 +1 @@
+#include <felspar/coro/ambient.hpp>
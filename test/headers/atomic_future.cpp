@@ -0,0 +1 @@
+#include <felspar/coro/atomic_future.hpp>
@@ -0,0 +1 @@
+#include <felspar/coro/atomic_shared_task.hpp>
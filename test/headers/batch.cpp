@@ -0,0 +1 @@
+#include <felspar/coro/batch.hpp>
@@ -0,0 +1 @@
+#include <felspar/coro/channel.hpp>
@@ -0,0 +1 @@
+#include <felspar/coro/elements_of.hpp>
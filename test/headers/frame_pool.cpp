@@ -0,0 +1 @@
+#include <felspar/coro/frame_pool.hpp>
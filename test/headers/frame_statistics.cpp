@@ -0,0 +1 @@
+#include <felspar/coro/frame_statistics.hpp>
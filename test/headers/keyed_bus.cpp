@@ -0,0 +1 @@
+#include <felspar/coro/keyed_bus.hpp>
@@ -0,0 +1 @@
+#include <felspar/coro/pipeline.hpp>
@@ -0,0 +1 @@
+#include <felspar/coro/reclaiming_starter.hpp>
@@ -0,0 +1 @@
+#include <felspar/coro/ring_bus.hpp>
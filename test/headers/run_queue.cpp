@@ -0,0 +1 @@
+#include <felspar/coro/run_queue.hpp>
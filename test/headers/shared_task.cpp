@@ -0,0 +1 @@
+#include <felspar/coro/shared_task.hpp>
@@ -0,0 +1 @@
+#include <felspar/coro/stack_arena.hpp>
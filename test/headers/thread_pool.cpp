@@ -0,0 +1 @@
+#include <felspar/coro/thread_pool.hpp>
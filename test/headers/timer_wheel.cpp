@@ -0,0 +1 @@
+#include <felspar/coro/timer_wheel.hpp>
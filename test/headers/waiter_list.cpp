@@ -0,0 +1 @@
+#include <felspar/coro/waiter_list.hpp>
@@ -0,0 +1 @@
+#include <felspar/coro/when_all.hpp>
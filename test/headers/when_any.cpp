@@ -0,0 +1 @@
+#include <felspar/coro/when_any.hpp>
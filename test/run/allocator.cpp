@@ -0,0 +1,98 @@
+#include <felspar/coro/generator.hpp>
+#include <felspar/coro/stream.hpp>
+#include <felspar/coro/task.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("allocator/pmr");
+
+
+    struct counting_resource : public std::pmr::memory_resource {
+        std::size_t allocations = {}, live = {};
+
+        void *do_allocate(std::size_t bytes, std::size_t align) override {
+            ++allocations;
+            ++live;
+            return std::pmr::new_delete_resource()->allocate(bytes, align);
+        }
+        void do_deallocate(
+                void *ptr, std::size_t bytes, std::size_t align) override {
+            --live;
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, align);
+        }
+        bool do_is_equal(
+                std::pmr::memory_resource const &o) const noexcept override {
+            return this == &o;
+        }
+    };
+
+
+    using allocator = std::pmr::polymorphic_allocator<>;
+    template<typename T>
+    using task = felspar::coro::task<T, allocator>;
+
+
+    task<int> tagged(std::allocator_arg_t, allocator, int n) { co_return n; }
+    task<int> first(allocator, int n) { co_return n; }
+    task<int> last(int n, allocator) { co_return n; }
+    task<int> resource(int n, std::pmr::memory_resource *) { co_return n; }
+    task<int> none(int n) { co_return n; }
+
+    struct handler {
+        int base;
+        task<int> member(std::allocator_arg_t, allocator, int n) {
+            co_return base + n;
+        }
+    };
+
+    felspar::coro::stream<int, allocator>
+            numbers(std::allocator_arg_t, allocator, int upto) {
+        for (int n{}; n < upto; ++n) { co_yield n; }
+    }
+
+
+    auto const conventions = suite.test("conventions", [](auto check) {
+        counting_resource r;
+        allocator alloc{&r};
+        check(tagged(std::allocator_arg, alloc, 1).get()) == 1;
+        check(r.allocations) == 1u;
+        check(first(alloc, 2).get()) == 2;
+        check(r.allocations) == 2u;
+        check(last(3, alloc).get()) == 3;
+        check(r.allocations) == 3u;
+        check(resource(4, &r).get()) == 4;
+        check(r.allocations) == 4u;
+        check(handler{10}.member(std::allocator_arg, alloc, 5).get()) == 15;
+        check(r.allocations) == 5u;
+        check(r.live) == 0u;
+    });
+
+
+    auto const fallback = suite.test("default resource", [](auto check) {
+        counting_resource r;
+        auto const previous = std::pmr::set_default_resource(&r);
+        check(none(6).get()) == 6;
+        std::pmr::set_default_resource(previous);
+        check(r.allocations) == 1u;
+        check(r.live) == 0u;
+    });
+
+
+    auto const streams = suite.test("stream", [](auto check) {
+        counting_resource r;
+        [&]() -> felspar::coro::task<void> {
+            int total{};
+            auto s = numbers(std::allocator_arg, allocator{&r}, 4);
+            while (auto n = co_await s.next()) { total += *n; }
+            check(total) == 6;
+        }()
+                         .get();
+        check(r.allocations) == 1u;
+        check(r.live) == 0u;
+    });
+
+
+}
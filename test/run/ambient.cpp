@@ -0,0 +1,116 @@
+#include <felspar/coro/ambient.hpp>
+#include <felspar/coro/generator.hpp>
+#include <felspar/coro/stream.hpp>
+#include <felspar/coro/task.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("ambient");
+
+
+    struct counting_resource : public std::pmr::memory_resource {
+        std::size_t allocations = {}, live = {};
+
+        void *do_allocate(std::size_t bytes, std::size_t align) override {
+            ++allocations;
+            ++live;
+            return std::pmr::new_delete_resource()->allocate(bytes, align);
+        }
+        void do_deallocate(
+                void *ptr, std::size_t bytes, std::size_t align) override {
+            --live;
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, align);
+        }
+        bool do_is_equal(
+                std::pmr::memory_resource const &o) const noexcept override {
+            return this == &o;
+        }
+    };
+
+
+    template<typename T>
+    using task = felspar::coro::task<T, felspar::coro::ambient_allocator>;
+
+
+    /// Suspends until resumed by hand
+    struct pause {
+        std::coroutine_handle<> *waiting;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) noexcept {
+            *waiting = h;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    task<int> leaf(int n) { co_return n; }
+    felspar::coro::generator<int, felspar::coro::ambient_allocator>
+            numbers(int upto) {
+        for (int n{}; n < upto; ++n) { co_yield n; }
+    }
+    felspar::coro::stream<int, felspar::coro::ambient_allocator>
+            doubled(int upto) {
+        for (int n{}; n < upto; ++n) { co_yield co_await leaf(2 * n); }
+    }
+    task<int> handler(std::coroutine_handle<> &waiting) {
+        int total = co_await leaf(1);
+        co_await pause{&waiting};
+        /// Resumed outside of any scope, but the children still use the
+        /// handler's resource
+        for (auto n : numbers(3)) { total += co_await leaf(n); }
+        auto d = doubled(2);
+        while (auto n = co_await d.next()) { total += *n; }
+        co_return total;
+    }
+
+
+    auto const propagate = suite.test("propagate", [](auto check) {
+        counting_resource arena;
+        std::coroutine_handle<> waiting;
+        auto t = [&]() {
+            felspar::coro::ambient_scope scope{arena};
+            return handler(waiting);
+        }();
+        check(arena.allocations) == 1u;
+        check(felspar::coro::ambient_resource())
+                == std::pmr::get_default_resource();
+
+        auto runner = [](task<int> &t) -> felspar::coro::task<int> {
+            co_return co_await std::move(t);
+        }(t).release();
+        runner.resume();
+        check(arena.allocations) == 2u;
+        check(felspar::coro::ambient_resource())
+                == std::pmr::get_default_resource();
+
+        waiting.resume();
+        /// One generator, one stream, and five more leaves
+        check(arena.allocations) == 9u;
+        check(felspar::coro::ambient_resource())
+                == std::pmr::get_default_resource();
+        check(runner.promise().consume_value()) == 1 + 3 + 2;
+        check(arena.live) == 0u;
+    });
+
+
+    auto const override_scope = suite.test("override", [](auto check) {
+        counting_resource outer, inner;
+        auto t = [&]() -> task<int> {
+            auto a = [&]() {
+                felspar::coro::ambient_scope scope{inner};
+                return leaf(1);
+            }();
+            auto b = leaf(2);
+            co_return co_await std::move(a) + co_await std::move(b);
+        };
+        felspar::coro::ambient_scope scope{outer};
+        check(t().get()) == 3;
+        check(outer.allocations) == 2u;
+        check(inner.allocations) == 1u;
+        check(outer.live + inner.live) == 0u;
+    });
+
+
+}
@@ -0,0 +1,104 @@
+#include <felspar/coro/atomic_bus.hpp>
+#include <felspar/coro/run_queue.hpp>
+#include <felspar/coro/starter.hpp>
+#include <felspar/test.hpp>
+
+#include <thread>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("atomic_bus");
+
+
+    using message_type = felspar::coro::atomic_bus<int>::message_type;
+
+
+    felspar::coro::task<void> wait_for(
+            felspar::coro::atomic_bus<int> &b,
+            message_type &message,
+            std::thread::id &thread) {
+        message = co_await b.next();
+        thread = std::this_thread::get_id();
+    }
+
+
+    auto const st = suite.test("single thread", [](auto check) {
+        felspar::coro::atomic_bus<int> b;
+        check(b.has_clients()) == false;
+        check(b.push(1)) == 0u;
+
+        felspar::coro::starter<> proc;
+        message_type first, second;
+        std::thread::id thread{};
+        proc.post(wait_for, std::ref(b), std::ref(first), std::ref(thread));
+        proc.post(wait_for, std::ref(b), std::ref(second), std::ref(thread));
+        check(b.has_clients()) == true;
+
+        check(b.push(42)) == 2u;
+        check(*first) == 42;
+        /// Both subscribers share the one value
+        check(first.get()) == second.get();
+        check(b.has_clients()) == false;
+        check(proc.wait_for_all().get()) == 2u;
+    });
+
+
+    auto const executors = suite.test("executors", [](auto check) {
+        felspar::coro::atomic_bus<int> b;
+        felspar::coro::run_queue q1, q2;
+        message_type m1, m2;
+        std::thread::id t1{}, t2{};
+        auto w1 = wait_for(b, m1, t1).release();
+        auto w2 = wait_for(b, m2, t2).release();
+        q1.post(w1.get());
+        q2.post(w2.get());
+        check(q1.run()) == 1u;
+        check(q2.run()) == 1u;
+
+        std::thread publisher{[&]() { b.push(7); }};
+        publisher.join();
+        /// Each waiter is posted back to the queue it was waiting from
+        check(q1.size()) == 1u;
+        check(q2.size()) == 1u;
+        check(m1 == nullptr) == true;
+        q1.run();
+        check(w1.done()) == true;
+        check(w2.done()) == false;
+        q2.run();
+        check(w2.done()) == true;
+        check(*m1) == 7;
+        check(m1.get()) == m2.get();
+        check(t1 == std::this_thread::get_id()) == true;
+    });
+
+
+    felspar::coro::task<void> count_to(
+            felspar::coro::atomic_bus<int> &b,
+            std::atomic<int> &total,
+            int const upto) {
+        auto values = b.stream();
+        while (true) {
+            auto const v = co_await values.next();
+            total += **v;
+            if (**v == upto) { co_return; }
+        }
+    }
+    auto const threads = suite.test("threads", [](auto check) {
+        felspar::coro::atomic_bus<int> b;
+        std::atomic<int> total{};
+        felspar::coro::starter<> proc;
+        proc.post(count_to, std::ref(b), std::ref(total), 100);
+        std::thread publisher{[&]() {
+            for (int n{1}; n <= 100;) {
+                if (b.push(n)) { ++n; }
+            }
+        }};
+        publisher.join();
+        check(total.load()) == 5050;
+        check(proc.wait_for_all().get()) == 1u;
+    });
+
+
+}
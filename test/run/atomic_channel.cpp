@@ -0,0 +1,82 @@
+#include <felspar/coro/atomic_channel.hpp>
+#include <felspar/coro/starter.hpp>
+#include <felspar/coro/thread_pool.hpp>
+#include <felspar/test.hpp>
+
+#include <vector>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("atomic_channel");
+
+
+    felspar::coro::task<void>
+            produce(felspar::coro::atomic_channel<int> &ch, int const count) {
+        for (int n{}; n < count; ++n) { co_await ch.send(n); }
+    }
+    felspar::coro::task<void> consume(
+            felspar::coro::atomic_channel<int> &ch, std::vector<int> &into) {
+        while (auto v = co_await ch.receive()) { into.push_back(*v); }
+    }
+
+
+    auto const st = suite.test("single thread", [](auto check) {
+        felspar::coro::atomic_channel<int> ch{3};
+        check(ch.capacity()) == 4u;
+
+        felspar::coro::starter<> producer;
+        producer.post(produce, std::ref(ch), 10);
+
+        std::vector<int> got;
+        felspar::coro::starter<> consumer;
+        consumer.post(consume, std::ref(ch), std::ref(got));
+        check(got.size()) == 10u;
+        check(got.back()) == 9;
+        check(producer.wait_for_all().get()) == 1u;
+
+        ch.close();
+        check(consumer.wait_for_all().get()) == 1u;
+    });
+
+
+    felspar::coro::task<void> pool_produce(
+            felspar::coro::thread_pool &pool,
+            felspar::coro::atomic_channel<int> &ch,
+            int const count) {
+        co_await pool.schedule();
+        for (int n{1}; n <= count; ++n) { co_await ch.send(n); }
+    }
+    felspar::coro::task<void> pool_consume(
+            felspar::coro::thread_pool &pool,
+            felspar::coro::atomic_channel<int> &ch,
+            std::atomic<long> &total) {
+        co_await pool.schedule();
+        for (auto s = ch.stream(); auto v = co_await s.next();) {
+            total += *v;
+        }
+    }
+    auto const mt = suite.test("thread pool", [](auto check) {
+        felspar::coro::atomic_channel<int> ch{8};
+        std::atomic<long> total{};
+        {
+            felspar::coro::thread_pool consumers{2};
+            for (int c{}; c < 3; ++c) {
+                consumers.post(pool_consume(consumers, ch, total));
+            }
+            {
+                felspar::coro::thread_pool producers{2};
+                for (int p{}; p < 4; ++p) {
+                    producers.post(pool_produce(producers, ch, 5000));
+                }
+                producers.wait();
+            }
+            ch.close();
+            consumers.wait();
+        }
+        check(total.load()) == 4l * 5000l * 5001l / 2l;
+    });
+
+
+}
@@ -0,0 +1,110 @@
+#include <felspar/coro/atomic_future.hpp>
+#include <felspar/coro/run_queue.hpp>
+#include <felspar/coro/starter.hpp>
+#include <felspar/coro/thread_pool.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("atomic_future");
+
+
+    felspar::coro::task<void> wait_for(
+            felspar::coro::atomic_future<int> &f,
+            int &value,
+            std::thread::id &thread) {
+        value = co_await f;
+        thread = std::this_thread::get_id();
+    }
+
+
+    auto const st = suite.test("single thread", [](auto check) {
+        felspar::coro::atomic_future<int> fut;
+        check(fut.has_value()) == false;
+
+        felspar::coro::starter<> proc;
+        int value{};
+        std::thread::id thread{};
+        proc.post(wait_for, std::ref(fut), std::ref(value), std::ref(thread));
+        proc.post(wait_for, std::ref(fut), std::ref(value), std::ref(thread));
+        check(value) == 0;
+
+        fut.set_value(42);
+        check(value) == 42;
+        check(fut.value()) == 42;
+        check(thread == std::this_thread::get_id()) == true;
+        check(proc.wait_for_all().get()) == 2u;
+        check([&]() {
+            fut.set_value(2);
+        }).throws(felspar::stdexcept::logic_error{
+                "The future already has a value set"});
+    });
+
+
+    auto const inl = suite.test("no executor", [](auto check) {
+        felspar::coro::atomic_future<int> fut;
+
+        felspar::coro::starter<> proc;
+        int value{};
+        std::thread::id thread{};
+        proc.post(wait_for, std::ref(fut), std::ref(value), std::ref(thread));
+
+        std::thread::id setter_id{};
+        std::thread setter{[&]() {
+            setter_id = std::this_thread::get_id();
+            fut.set_value(42);
+        }};
+        setter.join();
+        check(value) == 42;
+        check(thread == setter_id) == true;
+    });
+
+
+    auto const rq = suite.test("run_queue", [](auto check) {
+        felspar::coro::run_queue queue;
+        felspar::coro::atomic_future<int> fut;
+
+        int value{};
+        std::thread::id thread{};
+        auto waiter = wait_for(fut, value, thread).release();
+        queue.post(waiter.get());
+        check(queue.run()) == 1u;
+        check(waiter.done()) == false;
+
+        std::thread setter{[&]() { fut.set_value(42); }};
+        setter.join();
+        check(value) == 0;
+        check(queue.size()) == 1u;
+        check(queue.run()) == 1u;
+        check(waiter.done()) == true;
+        check(value) == 42;
+        check(thread == std::this_thread::get_id()) == true;
+    });
+
+
+    felspar::coro::task<void> wait_on_pool(
+            felspar::coro::thread_pool &pool,
+            felspar::coro::atomic_future<void> &started,
+            felspar::coro::atomic_future<int> &f,
+            std::atomic<int> &total) {
+        co_await pool.schedule();
+        started.set_value();
+        total += co_await f;
+    }
+    auto const tp = suite.test("thread_pool", [](auto check) {
+        felspar::coro::thread_pool pool{2};
+        felspar::coro::atomic_future<void> started;
+        felspar::coro::atomic_future<int> fut;
+        std::atomic<int> total{};
+
+        pool.post(wait_on_pool(pool, started, fut, total));
+        while (not started.has_value()) { std::this_thread::yield(); }
+        fut.set_value(42);
+        pool.wait();
+        check(total.load()) == 42;
+    });
+
+
+}
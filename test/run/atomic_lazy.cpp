@@ -0,0 +1,52 @@
+#include <felspar/coro/atomic_lazy.hpp>
+#include <felspar/test.hpp>
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("atomic_lazy");
+
+
+    auto const once = suite.test("once", [](auto check) {
+        std::atomic<std::size_t> runs{};
+        auto const build = [&]() -> felspar::coro::atomic_lazy<std::vector<int>> {
+            ++runs;
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            co_return std::vector<int>(1000, 7);
+        };
+        auto index = build();
+        check(runs.load()) == 0u;
+
+        std::vector<std::vector<int> const *> seen(8);
+        std::vector<std::thread> threads;
+        for (auto &s : seen) {
+            threads.emplace_back([&]() { s = &index.value(); });
+        }
+        for (auto &t : threads) { t.join(); }
+        check(runs.load()) == 1u;
+        for (auto s : seen) { check(s) == seen.front(); }
+        check(seen.front()->size()) == 1000u;
+        check(index().size()) == 1000u;
+    });
+
+
+    auto const throws = suite.test("throws", [](auto check) {
+        std::size_t runs{};
+        auto const thrower = [&]() -> felspar::coro::atomic_lazy<int> {
+            ++runs;
+            throw std::runtime_error{"Test exception"};
+            co_return 0;
+        };
+        auto l = thrower();
+        check([&]() { l.value(); }).throws(std::runtime_error{"Test exception"});
+        check([&]() { l(); }).throws(std::runtime_error{"Test exception"});
+        check(runs) == 1u;
+    });
+
+
+}
@@ -1,7 +1,10 @@
 #include <felspar/coro/bus.hpp>
+#include <felspar/coro/eager.hpp>
 #include <felspar/coro/starter.hpp>
 #include <felspar/test.hpp>
 
+#include <array>
+
 
 namespace {
 
@@ -32,4 +35,43 @@ namespace {
     });
 
 
+    auto const c = suite.test("cancel", [](auto check) {
+        felspar::coro::bus<std::size_t> values;
+        std::array<std::size_t, 3> read{};
+        {
+            std::array<felspar::coro::eager<>, 3> waiters;
+            for (std::size_t n{}; n < read.size(); ++n) {
+                waiters[n].post(copy_value, std::ref(read[n]), std::ref(values));
+            }
+            check(values.has_clients()) == true;
+            check(values.push(1)) == 3u;
+            /// Destroying the middle waiter leaves the others in place
+            waiters[1].destroy();
+            check(values.push(2)) == 2u;
+        }
+        check(values.has_clients()) == false;
+        check(values.push(3)) == 0u;
+        check(read[0]) == 2u;
+        check(read[1]) == 1u;
+        check(read[2]) == 2u;
+    });
+
+
+    auto const d = suite.test("cancel whilst delivering", [](auto check) {
+        felspar::coro::bus<std::size_t> values;
+        std::size_t read{};
+        felspar::coro::eager<> later;
+        auto const canceller = [&]() -> felspar::coro::task<void> {
+            co_await values.next();
+            later.destroy();
+        };
+        felspar::coro::eager<> first;
+        first.post(canceller());
+        later.post(copy_value, std::ref(read), std::ref(values));
+        /// The second waiter is destroyed before it's reached
+        check(values.push(1)) == 1u;
+        check(read) == 0u;
+        check(values.has_clients()) == false;
+    });
+
 }
@@ -0,0 +1,115 @@
+#include <felspar/coro/cancellable.hpp>
+#include <felspar/coro/future.hpp>
+#include <felspar/coro/run_queue.hpp>
+#include <felspar/coro/stream.hpp>
+#include <felspar/coro/task.hpp>
+#include <felspar/test.hpp>
+
+#include <optional>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("cancellable");
+
+
+    /// An operation that completes by resuming its `continuation`
+    struct operation {
+        std::coroutine_handle<> **pending;
+        std::coroutine_handle<> continuation = {};
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) noexcept {
+            continuation = h;
+            *pending = &continuation;
+        }
+        std::optional<int> await_resume() const noexcept { return 42; }
+    };
+    void complete(std::coroutine_handle<> *const continuation) {
+        if (auto h = std::exchange(*continuation, {})) { h.resume(); }
+    }
+
+    felspar::coro::task<std::optional<int>> perform(
+            felspar::coro::cancellable &cancel,
+            std::coroutine_handle<> *&pending) {
+        co_return co_await cancel.signal_or(operation{&pending});
+    }
+
+
+    auto const direct = suite.test("direct", [](auto check) {
+        felspar::coro::cancellable cancel;
+        std::coroutine_handle<> *pending = nullptr;
+        auto t = perform(cancel, pending).release();
+        t.promise().started = true;
+        t.resume();
+        check(t.done()) == false;
+        complete(pending);
+        check(t.done()) == true;
+        check(*t.promise().consume_value()) == 42;
+    });
+
+
+    auto const executor = suite.test("executor", [](auto check) {
+        felspar::coro::run_queue queue;
+        felspar::coro::cancellable cancel{queue};
+        std::coroutine_handle<> *pending = nullptr;
+        auto t = perform(cancel, pending).release();
+        t.promise().started = true;
+        t.resume();
+        cancel.cancel();
+        /// The operation completes before the queue runs the coroutine
+        complete(pending);
+        check(t.done()) == false;
+        check(queue.run()) == 1u;
+        check(t.done()) == true;
+        check(t.promise().consume_value().has_value()) == false;
+    });
+
+
+
+    felspar::coro::stream<int> after(felspar::coro::future<int> &f) {
+        co_yield co_await f;
+    }
+    felspar::coro::task<std::optional<int>> first_of(
+            felspar::coro::cancellable &cancel,
+            felspar::coro::stream<int> &s) {
+        if (auto v = co_await cancel.signal_or(s.next())) {
+            co_return *v;
+        } else {
+            co_return {};
+        }
+    }
+
+
+    auto const stream = suite.test("stream", [](auto check) {
+        {
+            felspar::coro::cancellable cancel;
+            felspar::coro::future<int> f;
+            auto s = after(f);
+            auto t = first_of(cancel, s).release();
+            t.promise().started = true;
+            t.resume();
+            check(t.done()) == false;
+            f.set_value(42);
+            check(t.done()) == true;
+            check(*t.promise().consume_value()) == 42;
+        }
+        {
+            felspar::coro::run_queue queue;
+            felspar::coro::cancellable cancel{queue};
+            felspar::coro::future<int> f;
+            auto s = after(f);
+            auto t = first_of(cancel, s).release();
+            t.promise().started = true;
+            t.resume();
+            cancel.cancel();
+            check(t.done()) == false;
+            check(queue.run()) == 1u;
+            check(t.done()) == true;
+            check(t.promise().consume_value().has_value()) == false;
+        }
+    });
+
+
+}
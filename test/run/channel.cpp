@@ -0,0 +1,115 @@
+#include <felspar/coro/channel.hpp>
+#include <felspar/coro/run_queue.hpp>
+#include <felspar/coro/starter.hpp>
+#include <felspar/test.hpp>
+
+#include <vector>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("channel");
+
+
+    felspar::coro::task<void> produce(
+            felspar::coro::channel<int> &ch, int const count, int &sent) {
+        for (int n{}; n < count; ++n) {
+            if (co_await ch.send(n)) { ++sent; }
+        }
+    }
+    felspar::coro::task<void>
+            consume(felspar::coro::channel<int> &ch, std::vector<int> &into) {
+        while (auto v = co_await ch.receive()) { into.push_back(*v); }
+    }
+
+
+    auto const bp = suite.test("backpressure", [](auto check) {
+        felspar::coro::channel<int> ch{2};
+        check(ch.capacity()) == 2u;
+
+        felspar::coro::starter<> producer;
+        int sent{};
+        producer.post(produce, std::ref(ch), 5, std::ref(sent));
+        check(sent) == 2;
+        check(ch.size()) == 2u;
+
+        std::vector<int> got;
+        felspar::coro::starter<> consumer;
+        consumer.post(consume, std::ref(ch), std::ref(got));
+        check(sent) == 5;
+        check(got.size()) == 5u;
+        check(got.front()) == 0;
+        check(got.back()) == 4;
+
+        ch.close();
+        check(consumer.wait_for_all().get()) == 1u;
+        check(producer.wait_for_all().get()) == 1u;
+    });
+
+
+    auto const rv = suite.test("rendezvous", [](auto check) {
+        felspar::coro::channel<int> ch{0};
+
+        std::vector<int> got;
+        felspar::coro::starter<> consumer;
+        consumer.post(consume, std::ref(ch), std::ref(got));
+
+        felspar::coro::starter<> producer;
+        int sent{};
+        producer.post(produce, std::ref(ch), 3, std::ref(sent));
+        check(sent) == 3;
+        check(got.size()) == 3u;
+        check(ch.size()) == 0u;
+    });
+
+
+    auto const cl = suite.test("close", [](auto check) {
+        felspar::coro::channel<int> ch{1};
+
+        felspar::coro::starter<> producer;
+        int sent{};
+        producer.post(produce, std::ref(ch), 3, std::ref(sent));
+        check(sent) == 1;
+
+        ch.close();
+        check(ch.closed()) == true;
+        check(sent) == 1;
+        check(producer.wait_for_all().get()) == 1u;
+
+        std::vector<int> got;
+        felspar::coro::starter<> consumer;
+        consumer.post(consume, std::ref(ch), std::ref(got));
+        check(got.size()) == 1u;
+        check(consumer.wait_for_all().get()) == 1u;
+    });
+
+
+    felspar::coro::task<void>
+            sum_stream(felspar::coro::stream<int> s, int &total) {
+        while (auto v = co_await s.next()) { total += *v; }
+    }
+    auto const st = suite.test("stream", [](auto check) {
+        felspar::coro::run_queue queue;
+        felspar::coro::channel<int> ch{4, queue};
+
+        int total{};
+        felspar::coro::starter<> consumer;
+        consumer.post(sum_stream, ch.stream(), std::ref(total));
+
+        int sent{};
+        felspar::coro::starter<> producer;
+        producer.post(produce, std::ref(ch), 10, std::ref(sent));
+        check(sent) == 5;
+        check(total) == 0;
+        queue.run();
+        check(sent) == 10;
+        check(total) == 45;
+
+        ch.close();
+        queue.run();
+        check(consumer.wait_for_all().get()) == 1u;
+    });
+
+
+}
@@ -0,0 +1,91 @@
+#include <felspar/coro/frame_pool.hpp>
+#include <felspar/coro/generator.hpp>
+#include <felspar/coro/task.hpp>
+#include <felspar/test.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("frame_pool");
+
+
+    using pool = felspar::coro::frame_pool<>;
+
+
+    auto const reuse = suite.test("reuse", [](auto check) {
+        pool p;
+        auto const a = p.allocate(100);
+        p.deallocate(a, 100);
+        /// The same size class gets the frame back
+        auto const b = p.allocate(110);
+        check(b) == a;
+        p.deallocate(b, 110);
+        /// Large requests aren't pooled
+        auto const c = p.allocate(pool::max_size + 1);
+        p.deallocate(c, pool::max_size + 1);
+    });
+
+
+    auto const batches = suite.test("batches", [](auto check) {
+        felspar::coro::frame_pool<256, 4> small;
+        std::vector<void *> frames;
+        for (std::size_t n{}; n < 20; ++n) { frames.push_back(small.allocate(64)); }
+        for (auto f : frames) { small.deallocate(f, 64); }
+        /// Every frame comes back out of either the local list or the depot
+        std::vector<void *> again;
+        for (std::size_t n{}; n < 20; ++n) { again.push_back(small.allocate(64)); }
+        std::size_t reused{};
+        for (auto f : again) {
+            reused += std::find(frames.begin(), frames.end(), f) != frames.end();
+        }
+        check(reused) == 20u;
+        for (auto f : again) { small.deallocate(f, 64); }
+    });
+
+
+    auto const threads = suite.test("threads", [](auto check) {
+        felspar::coro::frame_pool<512, 8> shared;
+        std::vector<void *> frames;
+        for (std::size_t n{}; n < 40; ++n) {
+            frames.push_back(shared.allocate(48));
+        }
+        /// Released on another thread, which hands them to the depot as it
+        /// exits
+        std::thread{[&]() {
+            for (auto f : frames) { shared.deallocate(f, 48); }
+        }}.join();
+        std::size_t reused{};
+        std::vector<void *> again;
+        for (std::size_t n{}; n < 40; ++n) {
+            again.push_back(shared.allocate(48));
+            reused += std::find(frames.begin(), frames.end(), again.back())
+                    != frames.end();
+        }
+        check(reused) == 40u;
+        for (auto f : again) { shared.deallocate(f, 48); }
+    });
+
+
+    felspar::coro::task<int, pool> add(int a, int b) { co_return a + b; }
+    felspar::coro::task<int, pool> sum(int upto) {
+        int total{};
+        for (int n{}; n < upto; ++n) { total = co_await add(total, n); }
+        co_return total;
+    }
+    felspar::coro::generator<int, pool> count(int upto) {
+        for (int n{}; n < upto; ++n) { co_yield n; }
+    }
+    auto const coroutines = suite.test("coroutines", [](auto check) {
+        check(sum(100).get()) == 4950;
+        int total{};
+        for (auto n : count(10)) { total += n; }
+        check(total) == 45;
+    });
+
+
+}
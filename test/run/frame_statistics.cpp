@@ -0,0 +1,115 @@
+#define FELSPAR_CORO_FRAME_STATISTICS
+#include <felspar/coro/frame_pool.hpp>
+#include <felspar/coro/frame_statistics.hpp>
+#include <felspar/coro/generator.hpp>
+#include <felspar/coro/task.hpp>
+#include <felspar/test.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <string_view>
+#include <thread>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("frame_statistics");
+
+
+    struct leaves {};
+    struct pooled {};
+
+    template<typename T>
+    using task = felspar::coro::task<T, felspar::coro::frame_statistics<leaves>>;
+    using pooled_generator = felspar::coro::generator<
+            int,
+            felspar::coro::frame_statistics<pooled, felspar::coro::frame_pool<>>>;
+
+    task<int> leaf(int n) { co_return n; }
+    task<int> sum(int upto) {
+        int total{};
+        for (int n{}; n < upto; ++n) { total += co_await leaf(n); }
+        co_return total;
+    }
+    pooled_generator count(int upto) {
+        for (int n{}; n < upto; ++n) { co_yield n; }
+    }
+
+
+    std::size_t histogram_total(felspar::coro::frame_counts const &c) {
+        return std::accumulate(c.histogram.begin(), c.histogram.end(), 0u);
+    }
+
+
+    auto const counts = suite.test("counts", [](auto check) {
+        check(felspar::coro::frame_statistics_enabled) == true;
+        check(sum(10).get()) == 45;
+        auto const s = felspar::coro::frame_statistics<leaves>::snapshot();
+        check(s.allocations) == 11u;
+        check(s.live) == 0u;
+        check(s.live_bytes) == 0u;
+        /// `sum` and one `leaf` are alive at the same time
+        check(s.high_water) == 2u;
+        check(s.total_bytes) >= s.high_water_bytes;
+        check(histogram_total(s)) == 11u;
+
+        auto t = sum(3);
+        auto const during = felspar::coro::frame_statistics<leaves>::snapshot();
+        check(during.live) == 1u;
+        check(during.live_bytes) > 0u;
+    });
+
+
+    auto const tags = suite.test("tags", [](auto check) {
+        int total{};
+        for (auto n : count(5)) { total += n; }
+        check(total) == 10;
+        /// The counts are for the tag, whichever allocator is used
+        auto const s = felspar::coro::frame_statistics<pooled>::snapshot();
+        check(s.allocations) == 1u;
+        check(s.live) == 0u;
+    });
+
+
+    auto const sites = suite.test("sites", [](auto check) {
+        check(sum(4).get()) == 6;
+        auto const all = felspar::coro::frame_site_snapshot();
+        auto const leaf_site = std::find_if(all.begin(), all.end(), [](auto &s) {
+            return std::string_view{s.location.function_name()}.find("leaf")
+                    != std::string_view::npos;
+        });
+        check(leaf_site != all.end()) == true;
+        check(leaf_site->counts.allocations) >= 4u;
+        check(leaf_site->counts.live) == 0u;
+    });
+
+
+    auto const threads = suite.test("threads", [](auto check) {
+        auto const before = felspar::coro::frame_statistics<leaves>::snapshot();
+        std::thread other{[]() { sum(4).get(); }};
+        other.join();
+        check(sum(4).get()) == 6;
+        auto const after = felspar::coro::frame_statistics<leaves>::snapshot();
+        check(after.allocations - before.allocations) == 10u;
+        /// Each thread finds the same site
+        auto const all = felspar::coro::frame_site_snapshot();
+        check(std::count_if(all.begin(), all.end(), [](auto &s) {
+            return std::string_view{s.location.function_name()}.find("leaf")
+                    != std::string_view::npos;
+        })) == 1;
+    });
+
+
+    auto const buckets = suite.test("buckets", [](auto check) {
+        using fc = felspar::coro::frame_counts;
+        check(fc::bucket_of(1)) == 0u;
+        check(fc::bucket_of(16)) == 0u;
+        check(fc::bucket_of(17)) == 1u;
+        check(fc::bucket_of(32)) == 1u;
+        check(fc::bucket_of(1024)) == 6u;
+        check(fc::bucket_of(std::size_t{1} << 40)) == fc::buckets - 1;
+    });
+
+
+}
@@ -2,6 +2,7 @@
 #include <felspar/memory/stack.storage.hpp>
 #include <felspar/test.hpp>
 
+#include <array>
 #include <vector>
 
 
@@ -155,6 +156,106 @@ namespace {
                     });
 
 
+    felspar::coro::generator<int> chunks() {
+        std::vector<int> values{1, 2, 3, 4, 5};
+        co_yield std::span{values};
+        co_yield 6;
+        co_yield std::span{values}.first(2);
+    }
+    auto const gb =
+            felspar::testsuite("generator/batch")
+                    .test("next_batch",
+                          [](auto check) {
+                              auto f = take(10, fib());
+                              std::array<std::size_t, 4> buffer{};
+                              check(f.next_batch(buffer)) == 4u;
+                              check(buffer[3]) == 3u;
+                              check(f.next_batch(buffer)) == 4u;
+                              check(buffer[3]) == 21u;
+                              check(f.next_batch(buffer)) == 2u;
+                              check(buffer[1]) == 55u;
+                              check(f.next_batch(buffer)) == 0u;
+                          })
+                    .test("yield span",
+                          [](auto check) {
+                              auto c = chunks();
+                              check(c.next()) == 1;
+                              check(c.next()) == 2;
+                              std::array<int, 4> buffer{};
+                              check(c.next_batch(buffer)) == 4u;
+                              check(buffer[0]) == 3;
+                              check(buffer[3]) == 6;
+                              check(c.next()) == 1;
+                              check(c.next()) == 2;
+                              check(c.next()).is_falsey();
+
+                              std::vector<int> all;
+                              for (auto v : chunks()) { all.push_back(v); }
+                              check(all.size()) == 8u;
+                              check(all[5]) == 6;
+                          })
+                    .test("throws", [](auto check) {
+                        auto f = thrower(true);
+                        std::array<std::size_t, 4> buffer{};
+                        check([&]() { f.next_batch(buffer); })
+                                .throws(std::runtime_error{
+                                        "Ooops, something went wrong after "
+                                        "yield"});
+                    });
+
+
+
+    felspar::coro::generator<int> nested(int depth) {
+        co_yield depth;
+        if (depth > 0) { co_yield felspar::coro::elements_of(nested(depth - 1)); }
+        co_yield -depth;
+    }
+    felspar::coro::generator<std::size_t> delegate_throws() {
+        auto inner = thrower(true);
+        bool caught = false;
+        try {
+            co_yield felspar::coro::elements_of(inner);
+        } catch (std::runtime_error const &) { caught = true; }
+        if (caught) { co_yield 100u; }
+    }
+    auto const ge =
+            felspar::testsuite("generator/elements_of")
+                    .test("nested",
+                          [](auto check) {
+                              std::vector<int> all;
+                              for (auto v : nested(3)) { all.push_back(v); }
+                              check(all)
+                                      == std::vector{3, 2, 1, 0, 0, -1, -2, -3};
+                          })
+                    .test("deep",
+                          [](auto check) {
+                              auto g = nested(500);
+                              int total{}, count{};
+                              while (auto v = g.next()) {
+                                  total += *v;
+                                  ++count;
+                              }
+                              check(total) == 0;
+                              check(count) == 1002;
+                          })
+                    .test("batch",
+                          [](auto check) {
+                              auto g = nested(10);
+                              std::array<int, 8> buffer{};
+                              check(g.next_batch(buffer)) == 8u;
+                              check(buffer[7]) == 3;
+                              check(g.next_batch(buffer)) == 8u;
+                              check(buffer[7]) == -4;
+                              check(g.next_batch(buffer)) == 6u;
+                              check(buffer[5]) == -10;
+                          })
+                    .test("throws", [](auto check) {
+                        auto g = delegate_throws();
+                        check(g.next()) == 1u;
+                        check(g.next()) == 100u;
+                        check(g.next()).is_falsey();
+                    });
+
 #ifndef NDEBUG
     felspar::coro::generator<std::size_t, felspar::memory::stack_storage<>>
             alloc_fib(felspar::memory::stack_storage<> &) {
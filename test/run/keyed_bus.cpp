@@ -0,0 +1,69 @@
+#include <felspar/coro/eager.hpp>
+#include <felspar/coro/keyed_bus.hpp>
+#include <felspar/test.hpp>
+
+#include <string>
+#include <vector>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("keyed_bus");
+
+
+    using bus_type = felspar::coro::keyed_bus<std::string, int>;
+
+
+    felspar::coro::task<void>
+            collect(bus_type &b, std::string key, std::vector<int> &into) {
+        auto values = b.stream(key);
+        while (auto v = co_await values.next()) { into.push_back(*v); }
+    }
+
+
+    auto const dispatch = suite.test("dispatch", [](auto check) {
+        bus_type b;
+        std::vector<int> abc, xyz;
+        felspar::coro::eager<> c1{collect(b, "ABC", abc)};
+        felspar::coro::eager<> c2{collect(b, "XYZ", xyz)};
+        check(b.has_clients("ABC")) == true;
+        check(b.has_clients("DEF")) == false;
+
+        check(b.push("ABC", 1)) == 1u;
+        check(b.push("DEF", 2)) == 0u;
+        check(b.push("XYZ", 3)) == 1u;
+        check(b.push("ABC", 4)) == 1u;
+        check(abc) == std::vector{1, 4};
+        check(xyz) == std::vector{3};
+    });
+
+
+    auto const latest = suite.test("latest", [](auto check) {
+        bus_type b;
+        check(b.latest("ABC").has_value()) == false;
+        b.push("ABC", 1);
+        b.push("DEF", 2);
+        b.push("ABC", 3);
+        check(*b.latest("ABC")) == 3;
+        check(*b.latest("DEF")) == 2;
+        check(b.latest("XYZ").has_value()) == false;
+    });
+
+
+    auto const cancel = suite.test("cancel", [](auto check) {
+        bus_type b;
+        std::vector<int> first, second;
+        felspar::coro::eager<> c1{collect(b, "ABC", first)};
+        felspar::coro::eager<> c2{collect(b, "ABC", second)};
+        check(b.push("ABC", 1)) == 2u;
+        c1.destroy();
+        check(b.push("ABC", 2)) == 1u;
+        c2.destroy();
+        check(b.has_clients("ABC")) == false;
+        check(first) == std::vector{1};
+        check(second) == std::vector{1, 2};
+    });
+
+
+}
@@ -2,6 +2,8 @@
 #include <felspar/memory/slab.storage.hpp>
 #include <felspar/test.hpp>
 
+#include <vector>
+
 
 namespace {
 
@@ -36,6 +38,21 @@ namespace {
                               check(c()) == 42;
                               check(runs) == 1u;
                           })
+                    .test("value",
+                          [](auto check) {
+                              std::size_t runs = 0;
+                              auto const table =
+                                      [&]() -> felspar::coro::lazy<std::vector<int>> {
+                                  ++runs;
+                                  co_return std::vector<int>(1000, 7);
+                              };
+                              auto c = table();
+                              auto const &first = c.value();
+                              check(first.size()) == 1000u;
+                              /// The same object is returned every time
+                              check(&c.value()) == &first;
+                              check(runs) == 1u;
+                          })
                     .test("throws", [](auto check) {
                         auto const thrower = []() -> felspar::coro::lazy<int> {
                             throw std::runtime_error{"Test exception"};
@@ -0,0 +1,161 @@
+#include <felspar/coro/pipeline.hpp>
+#include <felspar/coro/task.hpp>
+#include <felspar/test.hpp>
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("pipeline");
+
+
+    felspar::coro::stream<int> numbers(int upto, int &yielded) {
+        for (int n{}; n < upto; ++n) {
+            ++yielded;
+            co_yield n;
+        }
+    }
+    felspar::coro::generator<int> count(int upto) {
+        for (int n{}; n < upto; ++n) { co_yield n; }
+    }
+    felspar::coro::generator<int> spans() {
+        std::array<int, 4> values{1, 2, 3, 4};
+        co_yield std::span<int>{values};
+        co_yield 5;
+    }
+    felspar::coro::stream<int> throws() {
+        co_yield 1;
+        throw std::runtime_error{"Stream failed"};
+    }
+
+    auto const odd = [](int const n) { return n % 2 == 1; };
+    auto const square = [](int const n) { return n * n; };
+
+
+    auto const sm = suite.test("stream/map", [](auto check) {
+        [&]() -> felspar::coro::task<void> {
+            int yielded{};
+            auto squares = numbers(4, yielded) | felspar::coro::map(square);
+            std::vector<int> results;
+            while (auto n = co_await squares.next()) { results.push_back(*n); }
+            check(results) == std::vector{0, 1, 4, 9};
+            check(yielded) == 4;
+        }()
+                         .get();
+    });
+
+
+    auto const sft = suite.test("stream/filter+take", [](auto check) {
+        [&]() -> felspar::coro::task<void> {
+            int yielded{};
+            auto odd_squares = numbers(100, yielded) | felspar::coro::filter(odd)
+                    | felspar::coro::map(square) | felspar::coro::take(3);
+            std::vector<int> results;
+            while (auto n = co_await odd_squares.next()) {
+                results.push_back(*n);
+            }
+            check(results) == std::vector{1, 9, 25};
+            /// The source isn't resumed after the last value has been taken
+            check(yielded) == 6;
+        }()
+                         .get();
+    });
+
+
+    auto const stw = suite.test("stream/take_while+chunk", [](auto check) {
+        [&]() -> felspar::coro::task<void> {
+            int yielded{};
+            auto chunks = numbers(100, yielded)
+                    | felspar::coro::take_while([](int n) { return n < 5; })
+                    | felspar::coro::chunk(2);
+            auto const first = co_await chunks.next();
+            check(*first) == std::vector{0, 1};
+            auto const second = co_await chunks.next();
+            check(*second) == std::vector{2, 3};
+            auto const last = co_await chunks.next();
+            check(*last) == std::vector{4};
+            auto const end = co_await chunks.next();
+            check(end.has_value()) == false;
+            check(yielded) == 6;
+        }()
+                         .get();
+    });
+
+
+    auto const sts = suite.test("stream/to_stream", [](auto check) {
+        [&]() -> felspar::coro::task<void> {
+            int yielded{};
+            auto labelled = numbers(3, yielded) | felspar::coro::enumerate()
+                    | felspar::coro::map([](auto p) {
+                                      return std::to_string(p.first) + ":"
+                                              + std::to_string(p.second * 10);
+                                  })
+                    | felspar::coro::to_stream();
+            std::vector<std::string> results;
+            while (auto s = co_await labelled.next()) { results.push_back(*s); }
+            check(results) == std::vector<std::string>{"0:0", "1:10", "2:20"};
+        }()
+                         .get();
+    });
+
+
+    auto const sth = suite.test("stream/throws", [](auto check) {
+        [&]() -> felspar::coro::task<void> {
+            auto piped = throws() | felspar::coro::map(square);
+            auto const first = co_await piped.next();
+            check(*first) == 1;
+            try {
+                co_await piped.next();
+                check(false) == true;
+            } catch (std::runtime_error const &e) {
+                check(e.what()) == std::string{"Stream failed"};
+            }
+        }()
+                         .get();
+    });
+
+
+    auto const gi = suite.test("generator/iterate", [](auto check) {
+        std::vector<int> results;
+        for (auto n : count(20) | felspar::coro::filter(odd)
+                     | felspar::coro::map(square)
+                     | felspar::coro::take_while([](int n) { return n < 100; })) {
+            results.push_back(n);
+        }
+        check(results) == std::vector{1, 9, 25, 49, 81};
+    });
+
+
+    auto const gs = suite.test("generator/spans", [](auto check) {
+        auto pairs = spans() | felspar::coro::chunk(2);
+        check(*pairs.next()) == std::vector{1, 2};
+        check(*pairs.next()) == std::vector{3, 4};
+        check(*pairs.next()) == std::vector{5};
+        check(pairs.next().has_value()) == false;
+
+        auto taken = spans() | felspar::coro::take(2);
+        check(*taken.next()) == 1;
+        check(*taken.next()) == 2;
+        check(taken.next().has_value()) == false;
+    });
+
+
+    auto const gts = suite.test("generator/to_stream", [](auto check) {
+        [&]() -> felspar::coro::task<void> {
+            auto evens = count(7)
+                    | felspar::coro::filter([](int n) { return n % 2 == 0; })
+                    | felspar::coro::to_stream();
+            std::vector<int> results;
+            while (auto n = co_await evens.next()) { results.push_back(*n); }
+            check(results) == std::vector{0, 2, 4, 6};
+        }()
+                         .get();
+    });
+
+
+}
@@ -0,0 +1,134 @@
+#include <felspar/coro/reclaiming_starter.hpp>
+#include <felspar/exceptions.hpp>
+#include <felspar/test.hpp>
+
+#include <array>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("reclaiming_starter");
+
+
+    /// Suspends until resumed by hand
+    struct pause {
+        std::coroutine_handle<> *waiting;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) noexcept {
+            *waiting = h;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    felspar::coro::task<void> co_throw(std::source_location loc) {
+        throw felspar::stdexcept::runtime_error{"A test exception", loc};
+        co_return;
+    }
+    felspar::coro::task<int> co_value(int v) { co_return v; }
+    felspar::coro::task<void> co_wait(std::coroutine_handle<> *h, int *out) {
+        co_await pause{h};
+        ++*out;
+    }
+
+
+    auto const reclaim = suite.test("reclaim", [](auto check) {
+        felspar::coro::reclaiming_starter<felspar::coro::task<int>> s;
+        s.post(co_value, 3);
+        s.post(co_value, 4);
+        /// Completed immediately, so nothing is left
+        check(s.empty()) == true;
+        check(s.size()) == 0u;
+    });
+
+
+    auto const suspended = suite.test("suspended", [](auto check) {
+        felspar::coro::reclaiming_starter<> s;
+        std::coroutine_handle<> a, b, c;
+        int count{};
+        s.post(co_wait, &a, &count);
+        s.post(co_wait, &b, &count);
+        s.post(co_wait, &c, &count);
+        check(s.size()) == 3u;
+        /// Complete out of order
+        b.resume();
+        check(s.size()) == 2u;
+        a.resume();
+        check(s.size()) == 1u;
+        check(count) == 2;
+        /// `c` is destroyed along with the starter
+    });
+
+
+    auto const wait = suite.test("wait_for_all", [](auto check) {
+        felspar::coro::reclaiming_starter<> s;
+        std::coroutine_handle<> a;
+        int count{};
+        s.post(co_wait, &a, &count);
+        auto waiter = s.wait_for_all().release();
+        waiter.resume();
+        check(waiter.done()) == false;
+        a.resume();
+        check(waiter.done()) == true;
+        check(count) == 1;
+        waiter.promise().consume_value();
+    });
+
+
+    auto const errors = suite.test("errors", [](auto check) {
+        felspar::coro::reclaiming_starter<> held;
+        held.post(co_throw, std::source_location::current());
+        check(held.empty()) == true;
+        check([&]() {
+            held.wait_for_all().get();
+        }).throws(felspar::stdexcept::runtime_error{"A test exception"});
+        held.wait_for_all().get();
+
+        std::size_t sunk{};
+        felspar::coro::reclaiming_starter<> sinking{
+                [&](std::exception_ptr) { ++sunk; }};
+        sinking.post(co_throw, std::source_location::current());
+        sinking.post(co_throw, std::source_location::current());
+        check(sunk) == 2u;
+        sinking.wait_for_all().get();
+    });
+
+
+    auto const bounded = suite.test("max_in_flight", [](auto check) {
+        felspar::coro::reclaiming_starter<> s{2};
+        check(s.max_in_flight()) == 2u;
+        std::array<std::coroutine_handle<>, 5> handles;
+        int count{};
+        check(s.try_post(co_wait(&handles[0], &count))) == true;
+        check(s.try_post(co_wait(&handles[1], &count))) == true;
+        check(s.try_post(co_wait(&handles[2], &count))) == false;
+
+        int spawned{};
+        auto const spawner = [&]() -> felspar::coro::task<void> {
+            for (std::size_t n{2}; n < handles.size(); ++n) {
+                co_await s.spawn(co_wait(&handles[n], &count));
+                ++spawned;
+            }
+        };
+        auto poster = spawner().release();
+        poster.resume();
+        check(spawned) == 0;
+        check(s.size()) == 2u;
+        /// Each completion admits one more
+        handles[1].resume();
+        check(spawned) == 1;
+        check(s.size()) == 2u;
+        check(s.try_post(co_wait(&handles[0], &count))) == false;
+        handles[0].resume();
+        handles[2].resume();
+        check(spawned) == 3;
+        check(poster.done()) == true;
+        check(s.size()) == 2u;
+        handles[3].resume();
+        handles[4].resume();
+        check(s.empty()) == true;
+        check(count) == 5;
+    });
+
+
+}
@@ -0,0 +1,125 @@
+#include <felspar/coro/eager.hpp>
+#include <felspar/coro/ring_bus.hpp>
+#include <felspar/test.hpp>
+
+#include <vector>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("ring_bus");
+
+
+    template<typename Bus>
+    felspar::coro::task<void> collect(
+            typename Bus::subscriber &sub, std::vector<int> &into) {
+        while (true) { into.push_back(co_await sub.next()); }
+    }
+    template<typename Bus>
+    felspar::coro::task<void> publish(Bus &b, int from, int to, int &sent) {
+        for (int n{from}; n < to; ++n) {
+            co_await b.publish(n);
+            ++sent;
+        }
+    }
+
+
+    auto const lossless = suite.test("lossless", [](auto check) {
+        using bus_type = felspar::coro::ring_bus<int, 4>;
+        bus_type b;
+        auto waiting = b.subscribe();
+        auto polling = b.subscribe();
+        check(b.subscriber_count()) == 2u;
+
+        std::vector<int> got;
+        felspar::coro::eager<> c{collect<bus_type>(waiting, got)};
+        check(b.try_push(1)) == true;
+        check(b.try_push(2)) == true;
+        check(got) == std::vector{1, 2};
+        /// The polling subscriber hasn't been waiting, but sees both values
+        check(polling.backlog()) == 2u;
+        auto const *first = polling.try_next();
+        check(first != nullptr) == true;
+        check(*first) == 1;
+        check(*polling.try_next()) == 2;
+        check(polling.try_next() == nullptr) == true;
+    });
+
+
+    auto const backpressure = suite.test("backpressure", [](auto check) {
+        using bus_type = felspar::coro::ring_bus<int, 2>;
+        bus_type b;
+        auto slow = b.subscribe();
+        int sent{};
+        felspar::coro::eager<> producer{publish(b, 0, 5, sent)};
+        /// The ring is full until the slow subscriber catches up
+        check(sent) == 2;
+        check(b.try_push(99)) == false;
+        check(*slow.try_next()) == 0;
+        /// Still holding a reference to the value
+        check(sent) == 2;
+        check(*slow.try_next()) == 1;
+        check(sent) == 3;
+        std::vector<int> rest;
+        while (auto v = slow.try_next()) { rest.push_back(*v); }
+        check(rest) == std::vector{2, 3, 4};
+        check(sent) == 5;
+        check(producer.done()) == true;
+    });
+
+
+    auto const unsubscribe = suite.test("unsubscribe", [](auto check) {
+        using bus_type = felspar::coro::ring_bus<int, 2>;
+        bus_type b;
+        int sent{};
+        felspar::coro::eager<> producer;
+        {
+            auto slow = b.subscribe();
+            producer.post(publish<bus_type>, std::ref(b), 0, 6, std::ref(sent));
+            check(sent) == 2;
+        }
+        /// Nobody is left to hold the publisher back
+        check(sent) == 6;
+        check(b.subscriber_count()) == 0u;
+        check(b.sequence()) == 6u;
+    });
+
+
+    auto const unsubscribe_holding =
+            suite.test("unsubscribe holding", [](auto check) {
+                using bus_type = felspar::coro::ring_bus<int, 1>;
+                bus_type b;
+                int sent{};
+                felspar::coro::eager<> producer;
+                {
+                    auto sub = b.subscribe();
+                    check(b.try_push(0)) == true;
+                    check(*sub.try_next()) == 0;
+                    producer.post(
+                            publish<bus_type>, std::ref(b), 1, 2, std::ref(sent));
+                    check(sent) == 0;
+                }
+                /// Dropping the held value lets the waiting publisher write
+                check(sent) == 1;
+                check(producer.done()) == true;
+                check(b.subscriber_count()) == 0u;
+                check(b.try_push(2)) == true;
+                check(b.try_push(3)) == true;
+            });
+
+
+    auto const lapped = suite.test("lapped", [](auto check) {
+        felspar::coro::ring_bus<int, 3, felspar::coro::ring_bus_overflow::lap> b;
+        auto sub = b.subscribe();
+        for (int n{}; n < 7; ++n) { b.push(n); }
+        check(sub.backlog()) == 7u;
+        check(*sub.try_next()) == 4;
+        check(sub.missed()) == 4u;
+        check(*sub.try_next()) == 5;
+        check(*sub.try_next()) == 6;
+        check(sub.try_next() == nullptr) == true;
+    });
+
+
+}
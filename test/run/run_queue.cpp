@@ -0,0 +1,114 @@
+#include <felspar/coro/bus.hpp>
+#include <felspar/coro/cancellable.hpp>
+#include <felspar/coro/future.hpp>
+#include <felspar/coro/run_queue.hpp>
+#include <felspar/coro/starter.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("run_queue");
+
+
+    felspar::coro::task<void> count(std::size_t &c) {
+        ++c;
+        co_return;
+    }
+    auto const fifo = suite.test("fifo", [](auto check) {
+        felspar::coro::run_queue q;
+        check(q.empty()) == true;
+        check(q.run_one()) == false;
+        check(q.run()) == 0u;
+
+        std::size_t c{};
+        auto t1 = count(c).release();
+        auto t2 = count(c).release();
+        q.post(t1.get());
+        q.post(t2.get());
+        check(q.size()) == 2u;
+        check(c) == 0u;
+
+        check(q.run_one()) == true;
+        check(c) == 1u;
+        check(t1.done()) == true;
+        check(t2.done()) == false;
+        check(q.run()) == 1u;
+        check(c) == 2u;
+        check(q.empty()) == true;
+    });
+
+
+    felspar::coro::task<void> copy_value(
+            std::size_t &read, felspar::coro::bus<std::size_t> &values) {
+        while (true) { read = co_await values.next(); }
+    }
+    auto const b = suite.test("bus", [](auto check) {
+        felspar::coro::run_queue q;
+        felspar::coro::bus<std::size_t> values{q};
+
+        felspar::coro::starter<> proc;
+        std::size_t read1{}, read2{};
+        proc.post(copy_value, std::ref(read1), std::ref(values));
+        proc.post(copy_value, std::ref(read2), std::ref(values));
+
+        check(values.push(1)) == 2u;
+        check(read1) == 0u;
+        check(read2) == 0u;
+        check(q.size()) == 2u;
+
+        check(q.run(1)) == 1u;
+        check(q.run()) == 1u;
+        check(read1) == 1u;
+        check(read2) == 1u;
+
+        check(values.push(2)) == 2u;
+        check(q.run()) == 2u;
+        check(read1) == 2u;
+        check(read2) == 2u;
+    });
+
+
+    felspar::coro::task<void>
+            wait_for(int &read, felspar::coro::future<int> &f) {
+        read = co_await f;
+    }
+    auto const f = suite.test("future", [](auto check) {
+        felspar::coro::run_queue q;
+        felspar::coro::future<int> fut{q};
+
+        felspar::coro::starter<> proc;
+        int read{};
+        proc.post(wait_for, std::ref(read), std::ref(fut));
+
+        fut.set_value(42);
+        check(read) == 0;
+        check(q.size()) == 1u;
+        check(q.run()) == 1u;
+        check(read) == 42;
+        check(proc.wait_for_all().get()) == 1u;
+    });
+
+
+    felspar::coro::task<void>
+            wait_cancel(bool &done, felspar::coro::cancellable &c) {
+        co_await c;
+        done = true;
+    }
+    auto const c = suite.test("cancellable", [](auto check) {
+        felspar::coro::run_queue q;
+        felspar::coro::cancellable cancel{q};
+
+        felspar::coro::starter<> proc;
+        bool done = false;
+        proc.post(wait_cancel, std::ref(done), std::ref(cancel));
+
+        cancel.cancel();
+        check(done) == false;
+        check(q.run()) == 1u;
+        check(done) == true;
+    });
+
+
+}
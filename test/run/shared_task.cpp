@@ -0,0 +1,117 @@
+#include <felspar/coro/atomic_shared_task.hpp>
+#include <felspar/coro/shared_task.hpp>
+#include <felspar/coro/starter.hpp>
+#include <felspar/coro/thread_pool.hpp>
+#include <felspar/exceptions.hpp>
+#include <felspar/test.hpp>
+
+#include <string>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("shared_task");
+
+
+    /// Suspends until resumed by hand
+    struct pause {
+        std::coroutine_handle<> *waiting;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) noexcept {
+            *waiting = h;
+        }
+        void await_resume() const noexcept {}
+    };
+
+
+    felspar::coro::shared_task<std::string>
+            load(std::coroutine_handle<> *h, int &runs) {
+        ++runs;
+        co_await pause{h};
+        co_return "loaded";
+    }
+    felspar::coro::task<void> use(
+            felspar::coro::shared_task<std::string> config,
+            std::string const *&seen) {
+        seen = &co_await config;
+    }
+
+
+    auto const many = suite.test("many awaiters", [](auto check) {
+        std::coroutine_handle<> loading;
+        int runs{};
+        auto config = load(&loading, runs);
+        /// Not started until it is awaited
+        check(runs) == 0;
+
+        felspar::coro::starter<> proc;
+        std::string const *a = nullptr, *b = nullptr, *c = nullptr;
+        proc.post(use, config, std::ref(a));
+        proc.post(use, config, std::ref(b));
+        check(runs) == 1;
+        check(config.done()) == false;
+        loading.resume();
+        check(config.done()) == true;
+        /// Both see the same value, without a copy
+        check(*a) == "loaded";
+        check(a) == b;
+        /// Late awaiters don't suspend
+        proc.post(use, config, std::ref(c));
+        check(c) == a;
+        check(runs) == 1;
+        check(proc.wait_for_all().get()) == 3u;
+        check(config.get()) == "loaded";
+    });
+
+
+    felspar::coro::shared_task<int> twice(int v) { co_return 2 * v; }
+    felspar::coro::shared_task<void> fails() {
+        throw felspar::stdexcept::runtime_error{"A test exception"};
+        co_return;
+    }
+    auto const sync = suite.test("get", [](auto check) {
+        auto t = twice(21);
+        check(t.get()) == 42;
+        auto copy = t;
+        check(&copy.get()) == &t.get();
+        check([]() {
+            fails().get();
+        }).throws(felspar::stdexcept::runtime_error{"A test exception"});
+        std::coroutine_handle<> h;
+        int runs{};
+        check([&]() {
+            load(&h, runs).get();
+        }).throws(felspar::stdexcept::runtime_error{
+                "The shared_task hasn't completed"});
+    });
+
+
+    felspar::coro::atomic_shared_task<int>
+            compute(felspar::coro::thread_pool &pool, std::atomic<int> &runs) {
+        co_await pool.schedule();
+        ++runs;
+        co_return 42;
+    }
+    felspar::coro::task<void> add(
+            felspar::coro::thread_pool &pool,
+            felspar::coro::atomic_shared_task<int> t,
+            std::atomic<int> &total) {
+        co_await pool.schedule();
+        total += co_await t;
+    }
+    auto const threads = suite.test("atomic", [](auto check) {
+        felspar::coro::thread_pool pool{4};
+        std::atomic<int> runs{}, total{};
+        auto shared = compute(pool, runs);
+        for (int n{}; n < 20; ++n) {
+            pool.post(add(pool, shared, total));
+        }
+        pool.wait();
+        check(runs.load()) == 1;
+        check(total.load()) == 20 * 42;
+        check(shared.done()) == true;
+    });
+
+
+}
@@ -0,0 +1,93 @@
+#include <felspar/coro/stack_arena.hpp>
+#include <felspar/coro/task.hpp>
+#include <felspar/test.hpp>
+
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("stack_arena");
+
+
+    using arena = felspar::coro::stack_arena<>;
+
+
+    auto const lifo = suite.test("lifo", [](auto check) {
+        arena a;
+        auto const first = static_cast<std::byte *>(a.allocate(100));
+        auto const second = static_cast<std::byte *>(a.allocate(40));
+        check(second) == first + 112;
+        a.deallocate(second, 40);
+        auto const third = static_cast<std::byte *>(a.allocate(64));
+        check(third) == second;
+        a.deallocate(third, 64);
+        a.deallocate(first, 100);
+        check(a.allocate(16)) == first;
+        a.deallocate(first, 16);
+    });
+
+
+    auto const unordered = suite.test("out of order", [](auto check) {
+        arena a;
+        auto const first = a.allocate(64);
+        auto const second = a.allocate(64);
+        auto const third = a.allocate(64);
+        a.deallocate(first, 64);
+        /// The hole left by `first` isn't reused until the rest are released
+        auto const fourth = a.allocate(64);
+        check(fourth != first) == true;
+        a.deallocate(third, 64);
+        a.deallocate(fourth, 64);
+        a.deallocate(second, 64);
+        check(a.allocate(64)) == first;
+        a.deallocate(first, 64);
+    });
+
+
+    auto const segments = suite.test("segments", [](auto check) {
+        felspar::coro::stack_arena<4096> small;
+        std::vector<void *> frames;
+        for (std::size_t n{}; n < 100; ++n) {
+            frames.push_back(small.allocate(256));
+        }
+        while (not frames.empty()) {
+            small.deallocate(frames.back(), 256);
+            frames.pop_back();
+        }
+        auto const large = small.allocate(8192);
+        check(large != nullptr) == true;
+        small.deallocate(large, 8192);
+    });
+
+
+    auto const threads = suite.test("threads", [](auto check) {
+        felspar::coro::stack_arena<4096> shared;
+        std::vector<void *> frames;
+        std::thread{[&]() {
+            for (std::size_t n{}; n < 40; ++n) {
+                frames.push_back(shared.allocate(200));
+            }
+        }}.join();
+        /// The segments outlive the thread that allocated them
+        for (auto f : frames) { shared.deallocate(f, 200); }
+        check(frames.size()) == 40u;
+    });
+
+
+    felspar::coro::task<std::size_t, arena> depth(std::size_t const n) {
+        if (n == 0) {
+            co_return 0;
+        } else {
+            co_return 1 + co_await depth(n - 1);
+        }
+    }
+    auto const recursive = suite.test("recursive task", [](auto check) {
+        check(depth(2000).get()) == 2000u;
+        check(depth(10).get()) == 10u;
+    });
+
+
+}
@@ -2,6 +2,9 @@
 #include <felspar/exceptions.hpp>
 #include <felspar/test.hpp>
 
+#include <array>
+#include <vector>
+
 
 namespace {
 
@@ -65,4 +68,65 @@ namespace {
             });
 
 
+    /// Suspends until resumed by hand
+    struct pause {
+        std::coroutine_handle<> *waiting;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) noexcept {
+            *waiting = h;
+        }
+        void await_resume() const noexcept {}
+    };
+    felspar::coro::task<int> co_paused(std::coroutine_handle<> *h, int v) {
+        co_await pause{h};
+        co_return v;
+    }
+
+
+    auto const completion = felspar::testsuite(
+            "starter/completion",
+            [](auto check) {
+                felspar::coro::starter<felspar::coro::task<int>> s;
+                std::coroutine_handle<> a, b, c;
+                s.post(co_paused, &a, 1);
+                s.post(co_paused, &b, 2);
+                s.post(co_paused, &c, 3);
+                auto first = s.wait_for_any().release();
+                first.resume();
+                check(first.done()) == false;
+                b.resume();
+                check(first.done()) == true;
+                check(first.promise().consume_value()) == 2;
+                check(s.size()) == 2u;
+                /// Completing another doesn't continue the finished wait
+                c.resume();
+                check(s.wait_for_any().get()) == 3;
+                a.resume();
+                check(s.wait_for_any().get()) == 1;
+                check(s.empty()) == true;
+                check([&]() {
+                    s.wait_for_any().get();
+                }).throws(felspar::stdexcept::logic_error{
+                        "Cannot call starter::wait_for_any() if there are no "
+                        "items"});
+            },
+            [](auto check) {
+                felspar::coro::starter<felspar::coro::task<int>> s;
+                std::array<std::coroutine_handle<>, 4> h;
+                for (int n{}; n < 4; ++n) { s.post(co_paused, &h[n], n); }
+                std::vector<int> order;
+                auto const collect = [&]() -> felspar::coro::task<void> {
+                    auto results = s.as_completed();
+                    while (auto r = co_await results.next()) {
+                        order.push_back(*r);
+                    }
+                };
+                auto collector = collect().release();
+                collector.resume();
+                for (auto n : {2, 0, 3, 1}) { h[n].resume(); }
+                check(collector.done()) == true;
+                check(order) == std::vector{2, 0, 3, 1};
+            });
+
+
 }
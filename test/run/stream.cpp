@@ -2,7 +2,9 @@
 #include <felspar/coro/stream.hpp>
 #include <felspar/test.hpp>
 
+#include <array>
 #include <variant>
+#include <vector>
 
 
 namespace {
@@ -85,4 +87,102 @@ namespace {
     });
 
 
+    felspar::coro::stream<int> chunks() {
+        std::vector<int> values{1, 2, 3, 4, 5};
+        co_yield std::span{values};
+        co_yield 6;
+        co_yield std::span{values}.first(2);
+    }
+    auto const sbatch = suite.test(
+            "batch",
+            [](auto check) {
+                [&]() -> felspar::coro::task<void> {
+                    auto nums = numbers(10);
+                    std::array<int, 4> buffer{};
+                    check(co_await nums.next_batch(buffer)) == 4u;
+                    check(buffer[0]) == 0;
+                    check(buffer[3]) == 3;
+                    auto n = co_await nums.next();
+                    check(n.value()) == 4;
+                    check(co_await nums.next_batch(buffer)) == 4u;
+                    check(buffer[3]) == 8;
+                    check(co_await nums.next_batch(buffer)) == 1u;
+                    check(buffer[0]) == 9;
+                    check(co_await nums.next_batch(buffer)) == 0u;
+                }()
+                                 .get();
+            },
+            [](auto check) {
+                [&]() -> felspar::coro::task<void> {
+                    auto c = chunks();
+                    auto one = co_await c.next();
+                    check(one.value()) == 1;
+                    std::array<int, 3> buffer{};
+                    check(co_await c.next_batch(buffer)) == 3u;
+                    check(buffer[2]) == 4;
+                    check(co_await c.next_batch(buffer)) == 3u;
+                    check(buffer[0]) == 5;
+                    check(buffer[1]) == 6;
+                    check(buffer[2]) == 1;
+                    auto two = co_await c.next();
+                    check(two.value()) == 2;
+                    auto done = co_await c.next();
+                    check(done).is_falsey();
+                }()
+                                 .get();
+            });
+
+
+    felspar::coro::stream<int> nested(int depth) {
+        co_yield depth;
+        if (depth > 0) { co_yield felspar::coro::elements_of(nested(depth - 1)); }
+        co_yield -depth;
+    }
+    felspar::coro::stream<int> delegate_throws() {
+        co_yield 1;
+        bool caught = false;
+        try {
+            co_yield felspar::coro::elements_of([]() -> felspar::coro::stream<int> {
+                co_yield 2;
+                throw std::runtime_error{"Inner stream failed"};
+            }());
+        } catch (std::runtime_error const &) { caught = true; }
+        if (caught) { co_yield 3; }
+    }
+    auto const selements = suite.test(
+            "elements_of",
+            [](auto check) {
+                [&]() -> felspar::coro::task<void> {
+                    std::vector<int> all;
+                    for (auto s = nested(3); auto v = co_await s.next();) {
+                        all.push_back(*v);
+                    }
+                    check(all) == std::vector{3, 2, 1, 0, 0, -1, -2, -3};
+                }()
+                                 .get();
+            },
+            [](auto check) {
+                [&]() -> felspar::coro::task<void> {
+                    int total{}, count{};
+                    for (auto s = nested(500); auto v = co_await s.next();) {
+                        total += *v;
+                        ++count;
+                    }
+                    check(total) == 0;
+                    check(count) == 1002;
+                }()
+                                 .get();
+            },
+            [](auto check) {
+                [&]() -> felspar::coro::task<void> {
+                    std::vector<int> all;
+                    for (auto s = delegate_throws(); auto v = co_await s.next();) {
+                        all.push_back(*v);
+                    }
+                    check(all) == std::vector{1, 2, 3};
+                }()
+                                 .get();
+            });
+
+
 }
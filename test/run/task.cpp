@@ -84,4 +84,39 @@ namespace {
     });
 
 
+    struct counting_allocator {
+        static inline std::size_t allocated = {}, deallocated = {};
+        static inline std::size_t last_allocated = {}, last_deallocated = {};
+        void *allocate(std::size_t const bytes) {
+            allocated += bytes;
+            last_allocated = bytes;
+            return ::operator new(bytes);
+        }
+        void deallocate(void *const ptr, std::size_t const bytes) {
+            deallocated += bytes;
+            last_deallocated = bytes;
+            ::operator delete(ptr);
+        }
+    };
+    auto const sa = suite.test("stateless allocator", [](auto check) {
+        auto const answer = []() -> felspar::coro::task<int, counting_allocator> {
+            co_return 42;
+        };
+        check(answer().get()) == 42;
+        check(counting_allocator::allocated) > 0u;
+        /// The sized delete is given exactly what was allocated
+        check(counting_allocator::deallocated)
+                == counting_allocator::allocated;
+        check(counting_allocator::last_deallocated)
+                == counting_allocator::last_allocated;
+
+        /// Nothing is stored with the frame, so the allocator is asked for
+        /// exactly the frame size
+        using impl = felspar::coro::promise_allocator_impl<counting_allocator>;
+        void *const frame = impl::operator new(100);
+        check(counting_allocator::last_allocated) == 100u;
+        impl::operator delete(frame, 100);
+        check(counting_allocator::last_deallocated) == 100u;
+    });
+
 }
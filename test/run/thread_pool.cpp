@@ -0,0 +1,70 @@
+#include <felspar/coro/thread_pool.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("thread_pool");
+
+
+    felspar::coro::task<std::thread::id>
+            thread_id(felspar::coro::thread_pool &pool) {
+        co_await pool.schedule();
+        co_return std::this_thread::get_id();
+    }
+    felspar::coro::task<void> on_pool(
+            felspar::coro::thread_pool &pool,
+            std::atomic<std::thread::id> &id) {
+        id = co_await thread_id(pool);
+    }
+    auto const sch = suite.test("schedule", [](auto check) {
+        felspar::coro::thread_pool pool{2};
+        check(pool.size()) == 2u;
+        std::atomic<std::thread::id> id{std::this_thread::get_id()};
+        pool.post(on_pool(pool, id));
+        pool.wait();
+        check(id.load() != std::this_thread::get_id()) == true;
+    });
+
+
+    felspar::coro::task<std::size_t> leaf(
+            felspar::coro::thread_pool &pool, std::size_t const n) {
+        co_await pool.schedule();
+        co_return n;
+    }
+    felspar::coro::task<void> fan_out(
+            felspar::coro::thread_pool &pool,
+            std::atomic<std::size_t> &total,
+            std::size_t const n) {
+        total += co_await leaf(pool, n) + co_await leaf(pool, n);
+    }
+    auto const fo = suite.test("fan out", [](auto check) {
+        felspar::coro::thread_pool pool{4};
+        std::atomic<std::size_t> total{};
+        for (std::size_t n{}; n < 1000; ++n) {
+            pool.post(fan_out(pool, total, n));
+        }
+        pool.wait();
+        check(total.load()) == 999u * 1000u;
+        for (std::size_t n{}; n < 10; ++n) {
+            pool.post(fan_out(pool, total, n));
+        }
+        pool.wait();
+        check(total.load()) == 999u * 1000u + 90u;
+    });
+
+
+    felspar::coro::task<int> throws(felspar::coro::thread_pool &pool) {
+        co_await pool.schedule();
+        throw std::runtime_error{"Test throw"};
+    }
+    auto const t = suite.test("throws", [](auto check) {
+        felspar::coro::thread_pool pool{2};
+        pool.post(throws(pool));
+        check([&]() { pool.wait(); }).throws(std::runtime_error{"Test throw"});
+        pool.wait();
+    });
+
+
+}
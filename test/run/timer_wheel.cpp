@@ -0,0 +1,244 @@
+#include <felspar/coro/bus.hpp>
+#include <felspar/coro/future.hpp>
+#include <felspar/coro/run_queue.hpp>
+#include <felspar/coro/starter.hpp>
+#include <felspar/coro/timer_wheel.hpp>
+#include <felspar/test.hpp>
+
+
+using namespace std::chrono_literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("timer_wheel");
+
+
+    felspar::coro::task<void> sleeper(
+            felspar::coro::timer_wheel &timers,
+            felspar::coro::timer_wheel::time_point const when,
+            std::size_t &woken) {
+        co_await timers.sleep_until(when);
+        ++woken;
+    }
+    auto const sleep = suite.test("sleep", [](auto check) {
+        auto const start = felspar::coro::timer_wheel::clock::now();
+        felspar::coro::timer_wheel timers{1ms, start};
+        check(timers.next_wakeup().has_value()) == false;
+
+        felspar::coro::starter<> proc;
+        std::size_t woken{};
+        proc.post(sleeper, std::ref(timers), start + 10ms, std::ref(woken));
+        proc.post(sleeper, std::ref(timers), start + 100ms, std::ref(woken));
+        proc.post(sleeper, std::ref(timers), start + 5s, std::ref(woken));
+        proc.post(sleeper, std::ref(timers), start + 24h, std::ref(woken));
+        check(timers.size()) == 4u;
+        check(*timers.next_wakeup() <= start + 10ms) == true;
+
+        check(timers.advance(start + 9ms)) == 0u;
+        check(timers.advance(start + 10ms)) == 1u;
+        check(woken) == 1u;
+        check(timers.advance(start + 99ms)) == 0u;
+        check(timers.advance(start + 101ms)) == 1u;
+        check(timers.advance(start + 4999ms)) == 0u;
+        check(timers.advance(start + 5s)) == 1u;
+        check(timers.size()) == 1u;
+        check(timers.advance(start + 24h - 1ms)) == 0u;
+        check(timers.advance(start + 24h)) == 1u;
+        check(woken) == 4u;
+        check(timers.empty()) == true;
+        check(proc.wait_for_all().get()) == 4u;
+
+        /// Deadlines that have already passed don't suspend
+        proc.post(sleeper, std::ref(timers), start, std::ref(woken));
+        check(woken) == 5u;
+    });
+
+
+    auto const cancel = suite.test("cancel", [](auto check) {
+        auto const start = felspar::coro::timer_wheel::clock::now();
+        felspar::coro::timer_wheel timers{1ms, start};
+        std::size_t woken{};
+        {
+            felspar::coro::starter<> proc;
+            proc.post(sleeper, std::ref(timers), start + 1s, std::ref(woken));
+            proc.post(sleeper, std::ref(timers), start + 2s, std::ref(woken));
+            check(timers.size()) == 2u;
+        }
+        check(timers.size()) == 0u;
+        check(timers.advance(start + 3s)) == 0u;
+        check(woken) == 0u;
+    });
+
+
+    auto const many = suite.test("many", [](auto check) {
+        auto const start = felspar::coro::timer_wheel::clock::now();
+        felspar::coro::timer_wheel timers{1ms, start};
+        std::vector<felspar::coro::timer_node> nodes(10'000);
+        for (std::size_t i{}; i < nodes.size(); ++i) {
+            timers.schedule(
+                    nodes[i], start + std::chrono::milliseconds{(i * 7919) % 100'000 + 1});
+        }
+        check(timers.size()) == nodes.size();
+        for (std::size_t i{}; i < nodes.size(); i += 2) {
+            timers.cancel(nodes[i]);
+        }
+        check(timers.size()) == nodes.size() / 2;
+        /// Nodes without a coroutine handle only record that they fired
+        std::size_t fired{};
+        for (auto t = start; t <= start + 100s; t += 250ms) {
+            fired += timers.advance(t);
+            for (auto &n : nodes) {
+                if (n.fired) {
+                    check(n.expiry <= static_cast<std::uint64_t>((t - start) / 1ms))
+                            == true;
+                }
+            }
+        }
+        check(fired) == nodes.size() / 2;
+        check(timers.empty()) == true;
+    });
+
+
+    felspar::coro::task<std::optional<int>> wait_for(
+            felspar::coro::timer_wheel &timers,
+            felspar::coro::future<int> &fut,
+            std::chrono::milliseconds const timeout) {
+        co_return co_await timers.with_timeout(fut, timeout);
+    }
+    auto const future = suite.test("future", [](auto check) {
+        felspar::coro::timer_wheel timers;
+        {
+            felspar::coro::future<int> fut;
+            auto t = wait_for(timers, fut, 50ms).release();
+            t.promise().started = true;
+            t.resume();
+            check(t.done()) == false;
+            fut.set_value(42);
+            check(t.done()) == true;
+            check(*t.promise().consume_value()) == 42;
+            check(timers.empty()) == true;
+        }
+        {
+            felspar::coro::future<int> fut;
+            auto t = wait_for(timers, fut, 50ms).release();
+            t.promise().started = true;
+            t.resume();
+            check(timers.advance(
+                    felspar::coro::timer_wheel::clock::now() + 1s))
+                    == 1u;
+            check(t.done()) == true;
+            check(t.promise().consume_value().has_value()) == false;
+            fut.set_value(42);
+        }
+    });
+    auto const deferred = suite.test("future with executor", [](auto check) {
+        felspar::coro::run_queue queue;
+        felspar::coro::timer_wheel timers{1ms, queue};
+        {
+            felspar::coro::future<int> fut;
+            auto t = wait_for(timers, fut, 50ms).release();
+            t.promise().started = true;
+            t.resume();
+            fut.set_value(42);
+            check(t.done()) == true;
+            check(*t.promise().consume_value()) == 42;
+            check(timers.empty()) == true;
+            check(queue.empty()) == true;
+        }
+        {
+            felspar::coro::future<int> fut;
+            auto t = wait_for(timers, fut, 50ms).release();
+            t.promise().started = true;
+            t.resume();
+            check(timers.advance(
+                    felspar::coro::timer_wheel::clock::now() + 1s))
+                    == 1u;
+            /// The future completes after the timer has posted the task
+            fut.set_value(42);
+            check(t.done()) == false;
+            check(queue.run()) == 1u;
+            check(t.done()) == true;
+            check(t.promise().consume_value().has_value()) == false;
+        }
+    });
+
+
+    felspar::coro::task<std::size_t> read_bus(
+            felspar::coro::timer_wheel &timers, felspar::coro::bus<int> &b) {
+        std::size_t count{};
+        while (co_await timers.with_timeout(b.next(), 10ms)) { ++count; }
+        co_return count;
+    }
+    felspar::coro::task<void> never() {
+        felspar::coro::future<void> f;
+        co_await f;
+    }
+    felspar::coro::task<bool> wait_never(felspar::coro::timer_wheel &timers) {
+        co_return co_await timers.with_timeout(never(), 10ms);
+    }
+    felspar::coro::task<int> answer() { co_return 42; }
+    felspar::coro::task<std::optional<int>>
+            wait_answer(felspar::coro::timer_wheel &timers) {
+        co_return co_await timers.with_timeout(answer(), 10ms);
+    }
+    felspar::coro::stream<int> numbers(felspar::coro::timer_wheel &timers) {
+        co_yield 1;
+        co_await timers.sleep_for(1h);
+        co_yield 2;
+    }
+    felspar::coro::task<std::size_t>
+            read_stream(felspar::coro::timer_wheel &timers) {
+        auto s = numbers(timers);
+        std::size_t count{};
+        while (auto v = co_await timers.with_timeout(s.next(), 10ms)) {
+            if (not *v) { break; }
+            ++count;
+        }
+        co_return count;
+    }
+    auto later() { return felspar::coro::timer_wheel::clock::now() + 1s; }
+    auto const bus = suite.test("bus", [](auto check) {
+        felspar::coro::timer_wheel timers;
+        felspar::coro::bus<int> b;
+        felspar::coro::starter<felspar::coro::task<std::size_t>> proc;
+        proc.post(read_bus, std::ref(timers), std::ref(b));
+        b.push(1);
+        b.push(2);
+        check(timers.size()) == 1u;
+        check(timers.advance(later())) == 1u;
+        check(proc.next().get()) == 2u;
+    });
+    auto const task = suite.test("task", [](auto check) {
+        felspar::coro::timer_wheel timers;
+        auto t = wait_never(timers).release();
+        t.promise().started = true;
+        t.resume();
+        check(t.done()) == false;
+        check(timers.advance(later())) == 1u;
+        check(t.done()) == true;
+        check(t.promise().consume_value()) == false;
+
+        felspar::coro::timer_wheel fresh;
+        auto a = wait_answer(fresh).release();
+        a.promise().started = true;
+        a.resume();
+        check(a.done()) == true;
+        check(*a.promise().consume_value()) == 42;
+    });
+    auto const stream = suite.test("stream", [](auto check) {
+        felspar::coro::timer_wheel timers;
+        auto s = read_stream(timers).release();
+        s.promise().started = true;
+        s.resume();
+        check(s.done()) == false;
+        check(timers.size()) == 2u;
+        timers.advance(later());
+        check(s.done()) == true;
+        check(s.promise().consume_value()) == 1u;
+        check(timers.empty()) == true;
+    });
+
+
+}
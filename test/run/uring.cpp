@@ -0,0 +1,142 @@
+#include <felspar/coro/starter.hpp>
+#include <felspar/coro/uring.hpp>
+#include <felspar/test.hpp>
+
+#include <netinet/in.h>
+#include <fcntl.h>
+
+#include <cstdlib>
+#include <memory>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("uring");
+
+
+    /// Kernels or sandboxes without io_uring make these tests no-ops
+    std::unique_ptr<felspar::coro::uring> make_ring() {
+        try {
+            return std::make_unique<felspar::coro::uring>(32u);
+        } catch (std::system_error const &) { return {}; }
+    }
+
+    int temporary_file() {
+        char name[] = "/tmp/felspar-coro-uring-XXXXXX";
+        int const fd = ::mkstemp(name);
+        ::unlink(name);
+        return fd;
+    }
+
+    std::span<std::byte const> bytes(std::string_view const s) {
+        return std::as_bytes(std::span{s.data(), s.size()});
+    }
+
+
+    felspar::coro::task<std::string>
+            write_then_read(felspar::coro::uring &ring, int const fd) {
+        auto const written = co_await ring.write(fd, bytes("Hello world"), 0);
+        co_await ring.fsync(fd);
+        std::string buffer(written, '\0');
+        auto const read = co_await ring.read(
+                fd, std::as_writable_bytes(std::span{buffer}), 0);
+        buffer.resize(read);
+        co_await ring.close(fd);
+        co_return buffer;
+    }
+    auto const file = suite.test("file", [](auto check) {
+        auto ring = make_ring();
+        if (not ring) { return; }
+        check(ring->run(write_then_read(*ring, temporary_file())))
+                == "Hello world";
+        check(ring->outstanding()) == 0u;
+    });
+
+
+    felspar::coro::task<std::string>
+            registered(felspar::coro::uring &ring, int const fd) {
+        using registered_file = felspar::coro::uring::registered_file;
+        co_await ring.write(registered_file{0}, bytes("fixed"), 0);
+        std::array<std::byte, 16> storage{};
+        ::iovec iov{storage.data(), storage.size()};
+        ring.register_buffers(std::span{&iov, 1});
+        auto const read = co_await ring.read_fixed(
+                registered_file{0}, storage, 0, 0);
+        co_await ring.close(fd);
+        co_return std::string{
+                reinterpret_cast<char const *>(storage.data()),
+                static_cast<std::size_t>(read)};
+    }
+    auto const fixed = suite.test("registered", [](auto check) {
+        auto ring = make_ring();
+        if (not ring) { return; }
+        int const fd = temporary_file();
+        ring->register_files(std::span{&fd, 1});
+        check(ring->run(registered(*ring, fd))) == "fixed";
+    });
+
+
+    felspar::coro::task<void> serve(
+            felspar::coro::uring &ring, int const listener, std::string &got) {
+        int const fd = co_await ring.accept(listener);
+        std::array<std::byte, 64> buffer{};
+        while (auto const bytes = co_await ring.recv(fd, buffer)) {
+            got.append(
+                    reinterpret_cast<char const *>(buffer.data()),
+                    static_cast<std::size_t>(bytes));
+        }
+        co_await ring.close(fd);
+    }
+    felspar::coro::task<std::string>
+            loopback(felspar::coro::uring &ring, int const listener) {
+        ::sockaddr_in address{};
+        ::socklen_t length = sizeof(address);
+        ::getsockname(
+                listener, reinterpret_cast<::sockaddr *>(&address), &length);
+
+        std::string got;
+        felspar::coro::starter<> server;
+        server.post(serve, std::ref(ring), listener, std::ref(got));
+
+        int const fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        co_await ring.connect(
+                fd, reinterpret_cast<::sockaddr const *>(&address), length);
+        co_await ring.send(fd, bytes("ping "));
+        co_await ring.send(fd, bytes("pong"));
+        co_await ring.close(fd);
+        co_await server.wait_for_all();
+        co_return got;
+    }
+    auto const sockets = suite.test("loopback", [](auto check) {
+        auto ring = make_ring();
+        if (not ring) { return; }
+        int const listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        ::sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        check(::bind(listener, reinterpret_cast<::sockaddr *>(&address),
+                     sizeof(address)))
+                == 0;
+        check(::listen(listener, 4)) == 0;
+        check(ring->run(loopback(*ring, listener))) == "ping pong";
+        ::close(listener);
+    });
+
+
+    auto const errors = suite.test("errors", [](auto check) {
+        auto ring = make_ring();
+        if (not ring) { return; }
+        auto bad = [&]() -> felspar::coro::task<int> {
+            std::array<std::byte, 4> buffer{};
+            co_return co_await ring->read(-1, buffer, 0);
+        };
+        int error{};
+        try {
+            ring->run(bad());
+        } catch (std::system_error const &e) { error = e.code().value(); }
+        check(error) == EBADF;
+    });
+
+
+}
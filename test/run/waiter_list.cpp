@@ -0,0 +1,86 @@
+#include <felspar/coro/waiter_list.hpp>
+#include <felspar/test.hpp>
+
+#include <stdexcept>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("waiter_list");
+
+
+    auto const drain = suite.test("drain", [](auto check) {
+        felspar::coro::waiter_list list;
+        felspar::coro::waiter_node a, b, c;
+        list.push_back(a);
+        list.push_back(b);
+        list.push_back(c);
+        std::size_t seen{};
+        check(list.drain([&](felspar::coro::waiter_node &n) {
+            ++seen;
+            if (&n == &a) {
+                /// Removed before being reached, and re-added to the list
+                check(list.remove(b)) == false;
+                list.push_back(a);
+            }
+        })) == 2u;
+        check(seen) == 2u;
+        check(list.front()) == &a;
+        check(list.pop_front()) == &a;
+        check(list.empty()) == true;
+    });
+
+
+    auto const throws = suite.test("drain throws", [](auto check) {
+        felspar::coro::waiter_list list;
+        felspar::coro::waiter_node a, b, c, d;
+        list.push_back(a);
+        list.push_back(b);
+        list.push_back(c);
+        check([&]() {
+            list.drain([&](felspar::coro::waiter_node &n) {
+                if (&n == &b) {
+                    list.push_back(d);
+                    throw std::runtime_error{"Oops"};
+                }
+            });
+        }).throws(std::runtime_error{"Oops"});
+        /// Nodes not yet reached go back in front of those added
+        check(list.pop_front()) == &c;
+        check(list.pop_front()) == &d;
+        check(list.empty()) == true;
+    });
+
+
+
+    auto const assign = suite.test("move assign", [](auto check) {
+        felspar::coro::waiter_list from, to;
+        felspar::coro::waiter_node a, b, c;
+        from.push_back(a);
+        to.push_back(b);
+        to.push_back(c);
+        to = std::move(from);
+        check(from.empty()) == true;
+        /// The nodes that were in the target are no longer in any list
+        check(to.remove(b)) == false;
+        check(to.remove(c)) == false;
+        check(to.front()) == &a;
+        check(to.remove(a)) == true;
+        check(to.empty()) == true;
+    });
+
+
+    auto const destroyed = suite.test("destroyed", [](auto check) {
+        felspar::coro::waiter_node a;
+        {
+            felspar::coro::waiter_list list;
+            list.push_back(a);
+        }
+        felspar::coro::waiter_list other;
+        check(other.remove(a)) == false;
+        check(a.list == nullptr) == true;
+    });
+
+
+}
@@ -0,0 +1,126 @@
+#include <felspar/coro/future.hpp>
+#include <felspar/coro/thread_pool.hpp>
+#include <felspar/coro/when_all.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("when_all");
+
+
+    felspar::coro::task<int> immediate(int v) { co_return v; }
+    felspar::coro::task<std::string> wait_for(felspar::coro::future<int> &f) {
+        co_return std::to_string(co_await f);
+    }
+    felspar::coro::task<void> nothing(felspar::coro::future<int> &f) {
+        co_await f;
+    }
+
+    felspar::coro::task<std::tuple<int, std::string, std::monostate>>
+            tuple(felspar::coro::future<int> &a, felspar::coro::future<int> &b) {
+        co_return co_await felspar::coro::when_all(
+                immediate(1), wait_for(a), nothing(b));
+    }
+    auto const t = suite.test("tuple", [](auto check) {
+        felspar::coro::future<int> a, b;
+        auto h = tuple(a, b).release();
+        h.promise().started = true;
+        h.resume();
+        check(h.done()) == false;
+        b.set_value(2);
+        check(h.done()) == false;
+        a.set_value(3);
+        check(h.done()) == true;
+        auto const [i, s, v] = h.promise().consume_value();
+        check(i) == 1;
+        check(s) == "3";
+    });
+
+
+    felspar::coro::task<std::vector<int>> all_of(std::size_t const n) {
+        std::vector<felspar::coro::task<int>> tasks;
+        for (std::size_t i{}; i < n; ++i) {
+            tasks.push_back(immediate(static_cast<int>(i)));
+        }
+        co_return co_await felspar::coro::when_all(std::move(tasks));
+    }
+    auto const r = suite.test(
+            "range",
+            [](auto check) {
+                auto const v = all_of(5).get();
+                check(v.size()) == 5u;
+                check(v[0]) == 0;
+                check(v[4]) == 4;
+                check(all_of(0).get().empty()) == true;
+            },
+            [](auto check) {
+                felspar::coro::future<int> f;
+                auto h = [](felspar::coro::future<int> &f)
+                        -> felspar::coro::task<void> {
+                    std::vector<felspar::coro::task<void>> tasks;
+                    tasks.push_back(nothing(f));
+                    tasks.push_back(nothing(f));
+                    co_await felspar::coro::when_all(std::move(tasks));
+                }(f).release();
+                h.promise().started = true;
+                h.resume();
+                check(h.done()) == false;
+                f.set_value(1);
+                check(h.done()) == true;
+            });
+
+
+    felspar::coro::task<int> fails(felspar::coro::future<int> &f) {
+        co_await f;
+        throw std::runtime_error{"Fails"};
+    }
+    felspar::coro::task<std::tuple<int, int>>
+            failing(felspar::coro::future<int> &f) {
+        co_return co_await felspar::coro::when_all(fails(f), immediate(2));
+    }
+    auto const e = suite.test("exception", [](auto check) {
+        felspar::coro::future<int> f;
+        auto h = failing(f).release();
+        h.promise().started = true;
+        h.resume();
+        check(h.done()) == false;
+        f.set_value(1);
+        check(h.done()) == true;
+        check([&]() {
+            h.promise().consume_value();
+        }).throws(std::runtime_error{"Fails"});
+    });
+
+
+    felspar::coro::task<std::size_t> leaf(
+            felspar::coro::thread_pool &pool, std::size_t const n) {
+        co_await pool.schedule();
+        co_return n;
+    }
+    felspar::coro::task<void> gather(
+            felspar::coro::thread_pool &pool,
+            std::atomic<std::size_t> &total,
+            std::size_t const n) {
+        std::vector<felspar::coro::task<std::size_t>> tasks;
+        for (std::size_t i{}; i < n; ++i) { tasks.push_back(leaf(pool, i)); }
+        for (auto v : co_await felspar::coro::when_all(std::move(tasks))) {
+            total += v;
+        }
+        auto const [a, b] =
+                co_await felspar::coro::when_all(leaf(pool, 1), leaf(pool, 2));
+        total += a + b;
+    }
+    auto const p = suite.test("thread pool", [](auto check) {
+        felspar::coro::thread_pool pool{4};
+        std::atomic<std::size_t> total{};
+        for (std::size_t n{}; n < 100; ++n) {
+            pool.post(gather(pool, total, 100));
+        }
+        pool.wait();
+        check(total.load()) == 100u * (99u * 100u / 2u + 3u);
+    });
+
+
+}
@@ -0,0 +1,167 @@
+#include <felspar/coro/bus.hpp>
+#include <felspar/coro/future.hpp>
+#include <felspar/coro/run_queue.hpp>
+#include <felspar/coro/thread_pool.hpp>
+#include <felspar/coro/when_any.hpp>
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("when_any");
+
+
+    felspar::coro::task<int> immediate(int v) { co_return v; }
+    felspar::coro::task<int>
+            wait_for(felspar::coro::future<int> &f, std::size_t &destroyed) {
+        struct guard {
+            std::size_t &count;
+            ~guard() { ++count; }
+        } g{destroyed};
+        co_return co_await f;
+    }
+    felspar::coro::task<void> nothing(felspar::coro::future<int> &f) {
+        co_await f;
+    }
+
+
+    felspar::coro::task<std::pair<std::size_t, int>> first_of(
+            felspar::coro::future<int> &a,
+            felspar::coro::future<int> &b,
+            std::size_t &destroyed) {
+        std::vector<felspar::coro::task<int>> tasks;
+        tasks.push_back(wait_for(a, destroyed));
+        tasks.push_back(wait_for(b, destroyed));
+        co_return co_await felspar::coro::when_any(std::move(tasks));
+    }
+    auto const r = suite.test("range", [](auto check) {
+        felspar::coro::future<int> a, b;
+        std::size_t destroyed{};
+        auto h = first_of(a, b, destroyed).release();
+        h.promise().started = true;
+        h.resume();
+        check(h.done()) == false;
+        b.set_value(2);
+        check(h.done()) == true;
+        /// The loser is still waiting
+        check(destroyed) == 1u;
+        auto const [index, value] = h.promise().consume_value();
+        check(index) == 1u;
+        check(value) == 2;
+        a.set_value(1);
+        check(destroyed) == 2u;
+    });
+
+
+    felspar::coro::task<std::variant<int, std::monostate>>
+            variadic(felspar::coro::future<int> &a, felspar::coro::future<int> &b) {
+        co_return co_await felspar::coro::when_any(
+                [](felspar::coro::future<int> &f) -> felspar::coro::task<int> {
+                    co_return co_await f;
+                }(a),
+                nothing(b));
+    }
+    auto const v = suite.test(
+            "variadic",
+            [](auto check) {
+                felspar::coro::future<int> a, b;
+                auto h = variadic(a, b).release();
+                h.promise().started = true;
+                h.resume();
+                check(h.done()) == false;
+                b.set_value(1);
+                check(h.done()) == true;
+                check(h.promise().consume_value().index()) == 1u;
+                a.set_value(2);
+            },
+            [](auto check) {
+                felspar::coro::future<int> a, b;
+                a.set_value(4);
+                auto r = variadic(a, b).get();
+                check(r.index()) == 0u;
+                check(std::get<0>(r)) == 4;
+            });
+
+
+    felspar::coro::task<std::size_t> first_immediate(
+            felspar::coro::future<int> &f, std::size_t &destroyed) {
+        std::vector<felspar::coro::task<int>> tasks;
+        tasks.push_back(wait_for(f, destroyed));
+        tasks.push_back(immediate(1));
+        tasks.push_back(immediate(2));
+        tasks.push_back(wait_for(f, destroyed));
+        co_return (co_await felspar::coro::when_any(std::move(tasks))).first;
+    }
+    auto const i = suite.test("immediate", [](auto check) {
+        felspar::coro::future<int> f;
+        std::size_t destroyed{};
+        check(first_immediate(f, destroyed).get()) == 1u;
+        check(destroyed) == 0u;
+        /// The first is left running, and the last one is never started
+        f.set_value(0);
+        check(destroyed) == 1u;
+    });
+
+
+    felspar::coro::task<int> next_of(
+            felspar::coro::bus<int> &b, std::size_t &destroyed) {
+        struct guard {
+            std::size_t &count;
+            ~guard() { ++count; }
+        } g{destroyed};
+        co_return co_await b.next();
+    }
+    felspar::coro::task<std::size_t> first_queued(
+            felspar::coro::bus<int> &b,
+            felspar::coro::future<int> &f,
+            std::size_t &destroyed) {
+        std::vector<felspar::coro::task<int>> tasks;
+        tasks.push_back(next_of(b, destroyed));
+        tasks.push_back(wait_for(f, destroyed));
+        co_return (co_await felspar::coro::when_any(std::move(tasks))).first;
+    }
+    auto const q = suite.test("queued loser", [](auto check) {
+        felspar::coro::run_queue queue;
+        felspar::coro::bus<int> b{queue};
+        felspar::coro::future<int> f;
+        std::size_t destroyed{};
+        auto h = first_queued(b, f, destroyed).release();
+        h.promise().started = true;
+        h.resume();
+        /// The loser is posted to the queue before the winner completes
+        check(b.push(1)) == 1u;
+        f.set_value(2);
+        check(h.done()) == true;
+        check(h.promise().consume_value()) == 1u;
+        check(destroyed) == 1u;
+        h = {};
+        check(queue.run()) == 1u;
+        check(destroyed) == 2u;
+    });
+
+
+    felspar::coro::task<std::size_t> leaf(
+            felspar::coro::thread_pool &pool, std::size_t const n) {
+        co_await pool.schedule();
+        co_return n;
+    }
+    felspar::coro::task<void> race(
+            felspar::coro::thread_pool &pool, std::atomic<std::size_t> &total) {
+        std::vector<felspar::coro::task<std::size_t>> tasks;
+        for (std::size_t i{}; i < 10; ++i) { tasks.push_back(leaf(pool, i)); }
+        auto const [index, value] =
+                co_await felspar::coro::when_any(std::move(tasks));
+        if (index == value) { ++total; }
+    }
+    auto const p = suite.test("thread pool", [](auto check) {
+        felspar::coro::thread_pool pool{4};
+        std::atomic<std::size_t> total{};
+        for (std::size_t n{}; n < 100; ++n) { pool.post(race(pool, total)); }
+        /// The losers finish, and are destroyed, on the pool's threads
+        pool.wait();
+        check(total.load()) == 100u;
+    });
+
+
+}